@@ -0,0 +1,249 @@
+/**
+ * ARC implementation
+ */
+#include <algorithm>
+
+#include "buffer/arc_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+ARCReplacer<T>::ARCReplacer(size_t capacity) : capacity_(capacity) {}
+
+template <typename T> ARCReplacer<T>::~ARCReplacer() {}
+
+/*
+ * Record a reference and make the frame evictable. The first reference after a
+ * load keeps the frame in T1, any later one promotes it to the front of T2
+ */
+template <typename T> void ARCReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = frames_.find(value);
+  if (it == frames_.end()) {
+    // never loaded through Load, treat as a first reference
+    FrameInfo info;
+    t1_.push_front(value);
+    info.pos = t1_.begin();
+    it = frames_.emplace(value, info).first;
+  }
+  FrameInfo &info = it->second;
+  if (info.referenced) {
+    if (info.list == ListType::T1) {
+      recency_hits_++;
+      t1_.erase(info.pos);
+    } else {
+      frequency_hits_++;
+      t2_.erase(info.pos);
+    }
+    t2_.push_front(value);
+    info.list = ListType::T2;
+    info.pos = t2_.begin();
+  }
+  info.referenced = true;
+  if (!info.evictable) {
+    info.evictable = true;
+    evictable_count_++;
+  }
+}
+
+/*
+ * Evict from T1 while it is above its target size, otherwise from T2; if the
+ * chosen list has only pinned frames fall back to the other one. The evicted
+ * page id is remembered in the ghost list of its side
+ */
+template <typename T> bool ARCReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_count_ == 0) {
+    return false;
+  }
+  return ChooseVictim(value, nullptr);
+}
+
+/*
+ * Same choice of lists, restricted to frames that prefer accepts; the plain
+ * victim if it accepts none
+ */
+template <typename T>
+bool ARCReplacer<T>::PreferredVictim(
+    T &value, const std::function<bool(const T &)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_count_ == 0) {
+    return false;
+  }
+  return ChooseVictim(value, prefer) || ChooseVictim(value, nullptr);
+}
+
+/*
+ * Same choice of lists, restricted to frames that accept accepts
+ */
+template <typename T>
+bool ARCReplacer<T>::VictimIf(
+    T &value, const std::function<bool(const T &)> &accept) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_count_ == 0) {
+    return false;
+  }
+  return ChooseVictim(value, accept);
+}
+
+/*
+ * Caller must hold latch_
+ */
+template <typename T>
+bool ARCReplacer<T>::ChooseVictim(
+    T &value, const std::function<bool(const T &)> &prefer) {
+  if (!t1_.empty() && t1_.size() > target_) {
+    if (EvictFrom(t1_, b1_, b1_map_, value, prefer)) {
+      return true;
+    }
+    return EvictFrom(t2_, b2_, b2_map_, value, prefer);
+  }
+  if (EvictFrom(t2_, b2_, b2_map_, value, prefer)) {
+    return true;
+  }
+  return EvictFrom(t1_, b1_, b1_map_, value, prefer);
+}
+
+/*
+ * The frame got pinned, it stays in its list but cannot be evicted
+ */
+template <typename T> bool ARCReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = frames_.find(value);
+  if (it == frames_.end() || !it->second.evictable) {
+    return false;
+  }
+  it->second.evictable = false;
+  evictable_count_--;
+  return true;
+}
+
+template <typename T> size_t ARCReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_count_;
+}
+
+/*
+ * page_id was read into the frame (or created in it). A hit in a ghost list
+ * adapts the target size of T1 and puts the page straight into T2; otherwise
+ * the page starts in T1 and the ghost lists are trimmed to the directory size
+ * ARC keeps (|T1| + |B1| <= c, everything together <= 2c)
+ */
+template <typename T>
+void ARCReplacer<T>::Load(const T &value, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = frames_.find(value);
+  if (it != frames_.end()) {
+    // the frame came back from the free list without going through Victim
+    FrameInfo &old = it->second;
+    (old.list == ListType::T1 ? t1_ : t2_).erase(old.pos);
+    if (old.evictable) {
+      evictable_count_--;
+    }
+    frames_.erase(it);
+  }
+
+  FrameInfo info;
+  info.page_id = page_id;
+  auto b1 = b1_map_.find(page_id);
+  auto b2 = b2_map_.find(page_id);
+  if (b1 != b1_map_.end()) {
+    // should have been kept as a recent page, grow T1
+    b1_hits_++;
+    target_ = std::min(capacity_,
+                       target_ + std::max<size_t>(b2_.size() / b1_.size(), 1));
+    b1_.erase(b1->second);
+    b1_map_.erase(b1);
+    t2_.push_front(value);
+    info.list = ListType::T2;
+    info.pos = t2_.begin();
+  } else if (b2 != b2_map_.end()) {
+    // should have been kept as a frequent page, shrink T1
+    b2_hits_++;
+    size_t delta = std::max<size_t>(b1_.size() / b2_.size(), 1);
+    target_ = target_ > delta ? target_ - delta : 0;
+    b2_.erase(b2->second);
+    b2_map_.erase(b2);
+    t2_.push_front(value);
+    info.list = ListType::T2;
+    info.pos = t2_.begin();
+  } else {
+    t1_.push_front(value);
+    info.list = ListType::T1;
+    info.pos = t1_.begin();
+    while (!b1_.empty() && t1_.size() + b1_.size() > capacity_) {
+      DropGhost(b1_, b1_map_);
+    }
+    while (!b2_.empty() &&
+           t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_) {
+      DropGhost(b2_, b2_map_);
+    }
+  }
+  frames_.emplace(value, info);
+}
+
+/*
+ * Evict the least recently used unpinned frame of list (that prefer accepts,
+ * when given) and remember its page in ghost. Caller must hold latch_
+ */
+template <typename T>
+bool ARCReplacer<T>::EvictFrom(
+    std::list<T> &list, std::list<page_id_t> &ghost,
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> &ghost_map,
+    T &value, const std::function<bool(const T &)> &prefer) {
+  for (auto it = list.rbegin(); it != list.rend(); ++it) {
+    auto frame = frames_.find(*it);
+    if (!frame->second.evictable || (prefer && !prefer(*it))) {
+      continue;
+    }
+    value = *it;
+    page_id_t page_id = frame->second.page_id;
+    list.erase(std::next(it).base());
+    frames_.erase(frame);
+    evictable_count_--;
+    if (page_id != INVALID_PAGE_ID && ghost_map.find(page_id) == ghost_map.end()) {
+      ghost.push_front(page_id);
+      ghost_map[page_id] = ghost.begin();
+    }
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Forget the oldest ghost entry of ghost. Caller must hold latch_
+ */
+template <typename T>
+void ARCReplacer<T>::DropGhost(
+    std::list<page_id_t> &ghost,
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> &ghost_map) {
+  ghost_map.erase(ghost.back());
+  ghost.pop_back();
+}
+
+template <typename T> size_t ARCReplacer<T>::GetTarget() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return target_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetRecencyHits() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return recency_hits_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetFrequencyHits() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return frequency_hits_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetGhostHits(bool frequency) {
+  std::lock_guard<std::mutex> lock(latch_);
+  return frequency ? b2_hits_ : b1_hits_;
+}
+
+template class ARCReplacer<Page *>;
+// test only
+template class ARCReplacer<int>;
+
+} // namespace cmudb
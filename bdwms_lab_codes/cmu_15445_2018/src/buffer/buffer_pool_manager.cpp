@@ -1,40 +1,227 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <limits>
+#include <unordered_map>
+
 #include "buffer/buffer_pool_manager.h"
 
 namespace cmudb {
 
+/*
+ * time of an access, recorded in Page::access_stamp_ to order the resident
+ * pages by recency for warm-up
+ */
+static int64_t AccessStamp() {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
+ * When num_instances > 1, the pool_size frames are split across num_instances
+ * independent instances and this object only routes requests to them
+ * replacer_type selects the replacement policy of every instance
+ * prefault touches all frame memory up front instead of on first use
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                      DiskManager *disk_manager,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager),
-      log_manager_(log_manager) {
-  // a consecutive memory space for buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
-  replacer_ = new LRUReplacer<Page *>;
+                                     LogManager *log_manager,
+                                     size_t num_instances,
+                                     ReplacerType replacer_type,
+                                     bool prefault)
+    : pool_size_(pool_size), page_size_(disk_manager->GetPageSize()),
+      frame_arena_(num_instances > 1 ? 0 : pool_size * page_size_, prefault),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager), replacer_type_(replacer_type) {
+  size_t own_frames = pool_size_;
+  if (num_instances > 1) {
+    for (size_t i = 0; i < num_instances; ++i) {
+      size_t instance_size = pool_size / num_instances +
+          (i < pool_size % num_instances ? 1 : 0);
+      instances_.push_back(new BufferPoolManager(
+          instance_size, disk_manager, log_manager, 1, replacer_type,
+          prefault));
+    }
+    own_frames = 0;
+  }
+  capacity_ = own_frames;
+  num_online_ = own_frames;
+  offline_.assign(own_frames, false);
+  // frame metadata, the frame content lives in the (already zeroed) arena
+  pages_ = new Page[own_frames];
+  for (size_t i = 0; i < own_frames; ++i) {
+    pages_[i].data_ = frame_arena_.GetData() + i * page_size_;
+    pages_[i].page_size_ = page_size_;
+  }
+  page_table_ = new LinearProbeHashTable<page_id_t, Page *>(own_frames);
+  if (replacer_type == ReplacerType::CLOCK) {
+    replacer_ = new ClockReplacer<Page *>(own_frames, pages_);
+  } else if (replacer_type == ReplacerType::LRU_K) {
+    replacer_ = new LRUKReplacer<Page *>;
+  } else if (replacer_type == ReplacerType::ARC) {
+    replacer_ = new ARCReplacer<Page *>(own_frames);
+  } else {
+    replacer_ = new LRUReplacer<Page *>;
+  }
   free_list_ = new std::list<Page *>;
+  ring_.assign(std::min<size_t>(SEQUENTIAL_RING_SIZE, own_frames / 2), nullptr);
 
   // put all the pages into free list
-  for (size_t i = 0; i < pool_size_; ++i) {
+  for (size_t i = 0; i < own_frames; ++i) {
     free_list_->push_back(&pages_[i]);
   }
 }
 
+/*
+ * BufferPoolManager Constructor of a pool split into regions, region i with
+ * region_sizes[i] frames; the other parameters apply to every region
+ */
+BufferPoolManager::BufferPoolManager(const std::vector<size_t> &region_sizes,
+                                     DiskManager *disk_manager,
+                                     LogManager *log_manager,
+                                     size_t num_instances,
+                                     ReplacerType replacer_type,
+                                     bool prefault)
+    : BufferPoolManager(0, disk_manager, log_manager, 1, replacer_type,
+                        prefault) {
+  has_regions_ = true;
+  for (auto region_size : region_sizes) {
+    auto region = new BufferPoolManager(region_size, disk_manager, log_manager,
+                                        num_instances, replacer_type, prefault);
+    region->regions_owner_ = this;
+    instances_.push_back(region);
+    pool_size_ += region_size;
+  }
+}
+
 /*
  * BufferPoolManager Deconstructor
- * WARNING: Do Not Edit This Function
  */
 BufferPoolManager::~BufferPoolManager() {
+  StopResidentPageSaver();
+  StopPageCleaner();
+  if (shrink_thread_ != nullptr) {
+    {
+      lock_guard<mutex> lock(shrink_latch_);
+      shrink_stop_ = true;
+    }
+    shrink_cv_.notify_one();
+    shrink_thread_->join();
+    delete shrink_thread_;
+  }
+  if (prefetch_thread_ != nullptr) {
+    {
+      lock_guard<mutex> lock(prefetch_latch_);
+      prefetch_stop_ = true;
+      prefetch_cv_.notify_one();
+    }
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  for (auto instance : instances_) {
+    delete instance;
+  }
+  if (owns_compressed_cache_) {
+    delete compressed_cache_;
+  }
   delete[] pages_;
   delete page_table_;
   delete replacer_;
   delete free_list_;
 }
 
+/*
+ * Partitioned pool only: the instance that owns page_id. For a pool with
+ * regions, the region page_id is resident in, else the DATA region
+ */
+BufferPoolManager *BufferPoolManager::GetInstance(page_id_t page_id) {
+  if (has_regions_) {
+    for (auto region : instances_) {
+      if (region->IsResident(page_id)) {
+        return region;
+      }
+    }
+    return instances_[static_cast<size_t>(PoolRegion::DATA)];
+  }
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+/*
+ * true if p is one of the frames of this pool (or of its instances)
+ */
+bool BufferPoolManager::OwnsFrame(Page *p) {
+  for (auto instance : instances_) {
+    if (instance->OwnsFrame(p)) {
+      return true;
+    }
+  }
+  return p >= pages_ && p < pages_ + capacity_ && instances_.empty();
+}
+
+/*
+ * the pool to use for pages of region. A pool without regions serves all of
+ * them
+ */
+BufferPoolManager *BufferPoolManager::GetRegion(PoolRegion region) {
+  if (!has_regions_) {
+    return this;
+  }
+  return instances_[static_cast<size_t>(region)];
+}
+
+/*
+ * true if page_id is in the page table, without locking
+ */
+bool BufferPoolManager::IsResident(page_id_t page_id) {
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->IsResident(page_id);
+  }
+  Page *p = nullptr;
+  return page_table_->Find(page_id, p);
+}
+
+/*
+ * the hit path of FetchPage alone: pin page_id if it is resident and can be
+ * pinned right now, nullptr otherwise
+ */
+Page *BufferPoolManager::PinResident(page_id_t page_id) {
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->PinResident(page_id);
+  }
+  Page *p = nullptr;
+  if (!page_table_->Find(page_id, p) || !TryPin(p, page_id)) {
+    return nullptr;
+  }
+  counters_.fetch_hits.Add();
+  while (p->is_loading_) {
+    std::this_thread::yield();
+  }
+  return p;
+}
+
+/*
+ * Pool with regions only: pin page_id in whichever region it is resident.
+ * A frame that holds it but cannot be pinned is being evicted or deleted;
+ * wait until that is done, so that the page is not read from disk before its
+ * write-back is. Caller holds the region latch of page_id
+ */
+Page *BufferPoolManager::PinInAnyRegion(page_id_t page_id) {
+  for (auto region : instances_) {
+    while (region->IsResident(page_id)) {
+      Page *p = region->PinResident(page_id);
+      if (p != nullptr) {
+        return p;
+      }
+      std::this_thread::yield();
+    }
+  }
+  return nullptr;
+}
+
 /**
  * 1. search hash table.
  *  1.1 if exist, pin the page and return immediately
@@ -46,30 +233,69 @@ BufferPoolManager::~BufferPoolManager() {
  * 4. Update page metadata, read page content from disk file and return page
  * pointer
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  lock_guard<mutex> lock(latch_);
-  Page *p = nullptr;
-  if (page_table_->Find(page_id, p)) {  // if find the page in the page table
-    p->pin_count_++;
-    replacer_->Erase(p);
+Page *BufferPoolManager::FetchPage(page_id_t page_id, AccessHint hint) {
+  if (regions_owner_ == nullptr) {
+    return FetchPageLocal(page_id, hint);
+  }
+  // a region: the page may be resident in another region, and another region
+  // may be reading it in right now
+  Page *p = PinResident(page_id);
+  if (p != nullptr) {
     return p;
   }
-  p = GetVictimPage();  // find a replacement entry, in other words find a page that will be replaced
-  if (p == nullptr) {
+  lock_guard<mutex> region_lock(
+      regions_owner_->region_latches_[static_cast<size_t>(page_id) % 16]);
+  p = regions_owner_->PinInAnyRegion(page_id);
+  if (p != nullptr) {
     return p;
   }
-  if (p->is_dirty_) {  // if the page is dirty
-    if (ENABLE_LOGGING && log_manager_->GetPersistentLSN() < p->GetLSN()) {
-      log_manager_->Flush(true);
+  return FetchPageLocal(page_id, hint);
+}
+
+/*
+ * FetchPage within this pool (or its partitions) only
+ */
+Page *BufferPoolManager::FetchPageLocal(page_id_t page_id, AccessHint hint) {
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->FetchPage(page_id, hint);
+  }
+  // a resident page is pinned without latch_, see TryPin
+  Page *p = nullptr;
+  bool hit = page_table_->Find(page_id, p) && TryPin(p, page_id);
+  unique_lock<mutex> lock;
+  if (!hit) {
+    lock = LockLatch();
+    // it may have been read in (or released by an eviction) meanwhile
+    hit = page_table_->Find(page_id, p) && TryPin(p, page_id);
+  }
+  if (hit) {  // if find the page in the page table
+    counters_.fetch_hits.Add();
+    if (lock.owns_lock()) {
+      lock.unlock();
     }
-    disk_manager_->WritePage(p->GetPageId(), p->data_);
+    // a prefetch may still be reading it in, the pin keeps the frame ours
+    while (p->is_loading_) {
+      std::this_thread::yield();
+    }
+    return p;
+  }
+  counters_.fetch_misses.Add();
+  p = GetFrame(hint);  // find a replacement entry, in other words find a page that will be replaced
+  if (p == nullptr) {
+    return p;
   }
+  WriteBackVictim(p);
   page_table_->Remove(p->GetPageId());
   page_table_->Insert(page_id, p);  // prepare point p
-  disk_manager_->ReadPage(page_id, p->data_); // read the content from disk to p.data_ according to page_id
-  p->pin_count_ = 1;
+  replacer_->Load(p, page_id);
+  if (!p->in_ring_) {
+    replacer_->Insert(p);
+  }
+  ReadPageData(page_id, p->data_); // read the content from disk to p.data_ according to page_id
   p->is_dirty_ = false;
+  p->access_stamp_ = AccessStamp();
   p->page_id_ = page_id;
+  p->pin_count_ = 1;  // ends the claim, TryPin can pin it from now on
   return p;
 }
 
@@ -80,26 +306,125 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * dirty flag of this page
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  lock_guard<mutex> lock(latch_);
+  if (regions_owner_ != nullptr &&
+      regions_owner_->GetInstance(page_id) != this) {
+    return regions_owner_->GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+  }
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+  }
   Page *p = nullptr;
   page_table_->Find(page_id, p);
   if (p == nullptr) {
     return false;
   }
-  p->is_dirty_ |= is_dirty;  // pay attion to use | , false can't cover the true flag.
+  return UnpinFrame(p, is_dirty);
+}
 
-  if (p->GetPinCount() <= 0) {
-    cout << "DeletePage Error:" << p->page_id_ << endl;
-    assert(false);
-    return false;
+/*
+ * Unpin a frame the caller has pinned, which keeps p mapped to its page, so
+ * page guards skip the page table lookup of UnpinPage. Takes no latch: the
+ * frame stays in the replacer while it is pinned, the replacer learns about
+ * the access from is_referenced_ at the next eviction
+ */
+bool BufferPoolManager::UnpinFrame(Page *p, bool is_dirty) {
+  if (!instances_.empty()) {
+    return GetInstance(p->GetPageId())->UnpinFrame(p, is_dirty);
+  }
+  if (is_dirty) {  // false can't cover the true flag
+    p->is_dirty_ = true;
   }
+  int pins = p->pin_count_;
+  do {
+    if (pins <= 0) {
+      cout << "UnpinPage Error:" << p->page_id_ << endl;
+      assert(false);
+      return false;
+    }
+  } while (!p->pin_count_.compare_exchange_weak(pins, pins - 1));
+  return true;
+}
 
-  if (--p->pin_count_ == 0) {
-    replacer_->Insert(p);
+/*
+ * Latch-free pin of the frame the page table mapped page_id to. Fails if the
+ * frame is claimed (pin_count_ == -1) or was given to another page between
+ * the lookup and the pin. A successful pin sets is_referenced_ instead of
+ * touching the replacer
+ */
+bool BufferPoolManager::TryPin(Page *p, page_id_t page_id) {
+  int pins = p->pin_count_;
+  do {
+    if (pins < 0) {
+      return false;
+    }
+  } while (!p->pin_count_.compare_exchange_weak(pins, pins + 1));
+  if (p->page_id_ != page_id) {
+    UnpinFrame(p, false);
+    return false;
+  }
+  if (!p->is_referenced_.load(std::memory_order_relaxed)) {
+    p->is_referenced_.store(true, std::memory_order_relaxed);
+    p->access_stamp_.store(AccessStamp(), std::memory_order_relaxed);
   }
   return true;
 }
 
+/*
+ * Take an unpinned frame away from TryPin for eviction or deletion:
+ * pin_count_ goes from 0 to -1. Caller must hold latch_ and later store the
+ * new pin count
+ */
+bool BufferPoolManager::Claim(Page *p) {
+  int unpinned = 0;
+  return p->pin_count_.compare_exchange_strong(unpinned, -1);
+}
+
+/*
+ * Lock latch_. An uncontended acquisition only counts; otherwise the wait is
+ * timed into the latch wait histogram
+ */
+std::unique_lock<std::mutex> BufferPoolManager::LockLatch() {
+  counters_.latch_acquisitions.Add();
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    counters_.RecordLatchWait(std::chrono::steady_clock::now() - start);
+  }
+  return lock;
+}
+
+/*
+ * Fetch the page and latch it for reading (writing), the returned guard
+ * unlatches and unpins it. A partitioned pool hands out guards of the
+ * instance that owns the page so that they release straight to it
+ */
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id,
+                                               AccessHint hint) {
+  if (!instances_.empty() && regions_owner_ == nullptr) {
+    return GetInstance(page_id)->FetchPageRead(page_id, hint);
+  }
+  Page *p = FetchPage(page_id, hint);
+  if (p == nullptr) {
+    return ReadPageGuard();
+  }
+  p->RLatch();
+  return ReadPageGuard(this, p);
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id,
+                                                 AccessHint hint) {
+  if (!instances_.empty() && regions_owner_ == nullptr) {
+    return GetInstance(page_id)->FetchPageWrite(page_id, hint);
+  }
+  Page *p = FetchPage(page_id, hint);
+  if (p == nullptr) {
+    return WritePageGuard();
+  }
+  p->WLatch();
+  return WritePageGuard(this, p);
+}
+
 /*
  * Used to flush a particular page of the buffer pool to disk. Should call the
  * write_page method of the disk manager
@@ -107,19 +432,165 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * NOTE: make sure page_id != INVALID_PAGE_ID
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  lock_guard<mutex> lock(latch_);
+  if (regions_owner_ != nullptr &&
+      regions_owner_->GetInstance(page_id) != this) {
+    return regions_owner_->GetInstance(page_id)->FlushPage(page_id);
+  }
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->FlushPage(page_id);
+  }
+  auto lock = LockLatch();
   Page *p = nullptr;
   page_table_->Find(page_id, p);
   if (p == nullptr || p->page_id_ == INVALID_PAGE_ID) {
     return false;
   }
-  if (p->is_dirty_) {
+  // the page cleaner may be writing it right now; write it anyway so that the
+  // page is on disk when this returns
+  if (p->is_dirty_ || p->is_flushing_) {
     disk_manager_->WritePage(page_id, p->GetData());
     p->is_dirty_ = false;
   }
   return true;
 }
 
+/*
+ * Write back every dirty page of the pool, see FlushSorted
+ * @return: number of pages written
+ */
+size_t BufferPoolManager::FlushAllPages() {
+  lock_guard<mutex> flush_lock(flush_latch_);
+  return FlushSorted(0, std::numeric_limits<size_t>::max());
+}
+
+/*
+ * Incremental FlushAllPages: write back at most byte_budget bytes (but at
+ * least one page) of dirty pages, in page id order from the page after the
+ * last one the previous call wrote, wrapping around at the end
+ * @return: number of pages written
+ */
+size_t BufferPoolManager::FlushPages(size_t byte_budget) {
+  lock_guard<mutex> flush_lock(flush_latch_);
+  return FlushSorted(flush_cursor_,
+                     std::max<size_t>(1, byte_budget / page_size_));
+}
+
+/*
+ * Gather the dirty pages of all instances, sort them by page id starting at
+ * from, and write the first max_pages of them: each run of consecutive page
+ * ids is copied into one buffer (under each page's read latch, one page at a
+ * time) and written with a single DiskManager::WritePages. The log is flushed
+ * first if a run is ahead of it (WAL), and the file is synced once at the end.
+ * The pages stay pinned until their run is written, so that eviction cannot
+ * drop the (now clean) frame and read the old image back meanwhile.
+ * Caller holds flush_latch_
+ */
+size_t BufferPoolManager::FlushSorted(page_id_t from, size_t max_pages) {
+  std::vector<std::pair<page_id_t, Page *>> dirty;
+  CollectDirtyPages(dirty);
+  std::sort(dirty.begin(), dirty.end());
+  auto first = std::lower_bound(
+      dirty.begin(), dirty.end(),
+      std::make_pair(from, static_cast<Page *>(nullptr)));
+  std::rotate(dirty.begin(), first, dirty.end());
+  if (dirty.size() > max_pages) {
+    dirty.resize(max_pages);
+  }
+  if (dirty.empty()) {
+    return 0;
+  }
+  flush_cursor_ = dirty.back().first + 1;
+  PinForFlush(dirty);
+
+  std::vector<char> buffer(FLUSH_BATCH_PAGES * page_size_);
+  size_t written = 0;
+  size_t i = 0;
+  while (i < dirty.size()) {
+    if (dirty[i].second == nullptr) {  // evicted or cleaned meanwhile
+      i++;
+      continue;
+    }
+    size_t run = 0;
+    lsn_t max_lsn = INVALID_LSN;
+    page_id_t first_page_id = dirty[i].first;
+    while (i + run < dirty.size() && run < FLUSH_BATCH_PAGES &&
+           dirty[i + run].second != nullptr &&
+           dirty[i + run].first == first_page_id + static_cast<page_id_t>(run)) {
+      Page *p = dirty[i + run].second;
+      p->RLatch();
+      memcpy(buffer.data() + run * page_size_, p->GetData(), page_size_);
+      max_lsn = std::max(max_lsn, p->GetLSN());
+      p->RUnlatch();
+      run++;
+    }
+    if (ENABLE_LOGGING && log_manager_->GetPersistentLSN() < max_lsn) {
+      log_manager_->Flush(true);
+    }
+    disk_manager_->WritePages(first_page_id, buffer.data(), run);
+    for (size_t j = i; j < i + run; ++j) {
+      BufferPoolManager *owner =
+          instances_.empty() ? this : GetInstance(dirty[j].first);
+      owner->counters_.flushed_pages.Add();
+      owner->UnpinFrame(dirty[j].second, false);
+    }
+    written += run;
+    i += run;
+  }
+  disk_manager_->Sync();
+  return written;
+}
+
+/*
+ * Append the resident pages that are dirty, or being written by the page
+ * cleaner (which may not be done yet), to dirty
+ */
+void BufferPoolManager::CollectDirtyPages(
+    std::vector<std::pair<page_id_t, Page *>> &dirty) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      instance->CollectDirtyPages(dirty);
+    }
+    return;
+  }
+  auto lock = LockLatch();
+  for (size_t i = 0; i < capacity_; ++i) {
+    Page *p = &pages_[i];
+    if (p->page_id_ != INVALID_PAGE_ID && (p->is_dirty_ || p->is_flushing_)) {
+      dirty.emplace_back(p->page_id_, p);
+    }
+  }
+}
+
+/*
+ * Pin the frames of this instance in dirty that still hold the same page and
+ * mark them clean, an UnpinPage(dirty) during the write dirties them again.
+ * Entries whose page is gone are set to nullptr. No frame is claimed while
+ * latch_ is held, so the pin is a plain increment and skips is_referenced_:
+ * writing a page back is no access
+ */
+void BufferPoolManager::PinForFlush(
+    std::vector<std::pair<page_id_t, Page *>> &dirty) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      instance->PinForFlush(dirty);
+    }
+    return;
+  }
+  auto lock = LockLatch();
+  for (auto &entry : dirty) {
+    Page *p = entry.second;
+    if (p < pages_ || p >= pages_ + capacity_) {
+      continue;  // another instance's frame
+    }
+    if (p->page_id_ != entry.first || !(p->is_dirty_ || p->is_flushing_)) {
+      entry.second = nullptr;
+      continue;
+    }
+    p->pin_count_++;
+    p->is_dirty_ = false;
+  }
+}
+
 /**
  * User should call this method for deleting a page. This routine will call
  * disk manager to deallocate the page. First, if page is found within page
@@ -129,22 +600,42 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
  * the page is found within page table, but pin_count != 0, return false
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  lock_guard<mutex> lock(latch_);
+  if (regions_owner_ != nullptr &&
+      regions_owner_->GetInstance(page_id) != this) {
+    return regions_owner_->GetInstance(page_id)->DeletePage(page_id);
+  }
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->DeletePage(page_id);
+  }
+  auto lock = LockLatch();
   Page *p = nullptr;
   page_table_->Find(page_id, p);
   if (p == nullptr) {
+    if (compressed_cache_ != nullptr) {
+      compressed_cache_->Erase(page_id);
+    }
     disk_manager_->DeallocatePage(page_id);
   } else {
-    if (p->GetPinCount() > 0) {   // if there's still thread hold this page, return false
+    if (p->is_flushing_) {
+      return false;
+    }
+    if (p->is_retained_) {  // the pool's own pin does not keep a page alive
+      p->is_retained_ = false;
+      p->pin_count_--;
+      num_retained_--;
+    }
+    if (!Claim(p)) {   // if there's still thread hold this page, return false
 //      cout << "DeletePage Error in Delete func:" << p->page_id_ << endl;
 //      assert(false);
       return false;
     }
     replacer_->Erase(p);
+    LeaveRing(p);
     page_table_->Remove(page_id);
     p->is_dirty_ = false;
     p->ResetMemory();
     p->page_id_ = INVALID_PAGE_ID;
+    p->pin_count_ = 0;
     free_list_->push_back(p);
   }
   return true;
@@ -159,57 +650,1006 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * into page table. return nullptr if all the pages in pool are pinned
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
-  lock_guard<mutex> lock(latch_);
+  if (!instances_.empty()) {
+    // the page id decides the owning instance, so it is allocated up front
+    page_id = disk_manager_->AllocatePage();
+    return GetInstance(page_id)->NewPageWithId(page_id);
+  }
+  auto lock = LockLatch();
   Page *p = nullptr;
   p = GetVictimPage();  // get a victim page for allocated page from disk
   if (p == nullptr) {
     return p;
   }
   page_id = disk_manager_->AllocatePage();
-  if (p->is_dirty_) {
-    if (ENABLE_LOGGING && log_manager_->GetPersistentLSN() < p->GetLSN()) {
-      log_manager_->Flush(true);
-    }
-    disk_manager_->WritePage(p->GetPageId(), p->data_);
+  return InitNewPage(p, page_id);
+}
+
+/*
+ * Partitioned pool or pool with regions: create a page whose id was already
+ * allocated by the routing pool
+ */
+Page *BufferPoolManager::NewPageWithId(page_id_t page_id) {
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->NewPageWithId(page_id);
+  }
+  auto lock = LockLatch();
+  Page *p = GetVictimPage();
+  if (p == nullptr) {
+    return p;
   }
+  return InitNewPage(p, page_id);
+}
+
+/*
+ * write back the victim frame p if necessary and install page_id into it as a
+ * zeroed, pinned page. Caller must hold latch_
+ */
+Page *BufferPoolManager::InitNewPage(Page *p, page_id_t page_id) {
+  WriteBackVictim(p);
   page_table_->Remove(p->GetPageId());
   page_table_->Insert(page_id, p);
+  replacer_->Load(p, page_id);
+  replacer_->Insert(p);
+
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);  // a deleted page's id may come back
+  }
 
   // init the page meta-date
   p->page_id_ = page_id;
   p->ResetMemory();
   p->is_dirty_ = false;
-  p->pin_count_ = 1;
+  p->access_stamp_ = AccessStamp();
+  p->pin_count_ = 1;  // ends the claim
   return p;
 }
 
 /*
  * return the page that will be replaced from free list,
  * otherwise use lru replacer select an unpinned Page that was least recently used as the "victim" page
+ * Every resident frame stays in the replacer, pinned or not, so candidates
+ * must be unpinned; a frame hit since the last scan (is_referenced_) gets a
+ * second chance and its hit is recorded in the replacer instead. The victim
+ * is returned claimed (pin_count_ == -1). Caller must hold latch_
  */
 Page *BufferPoolManager::GetVictimPage() {
   Page *p = nullptr;
-  if (free_list_->empty()) {  // if there is no free page to be replaced, need to get from replacer
-    if (replacer_->Size() == 0) { // if there is no page to be replaced into the disk, return nullptr
-      return nullptr;
-    }
-    replacer_->Victim(p);  // return a page that need to be replaced
-  } else {
+  if (!free_list_->empty()) {
     p = free_list_->front();
     free_list_->pop_front();
     assert(p->GetPageId() == INVALID_PAGE_ID);
+    // only a TryPin that lost the race against DeletePage can hold it, and
+    // it lets go right away
+    while (!Claim(p)) {
+      std::this_thread::yield();
+    }
+    return p;
+  }
+  std::vector<Page *> referenced;
+  auto evictable = [&referenced](Page *const &page) {
+    if (page->pin_count_ != 0) {
+      return false;
+    }
+    if (page->is_referenced_.exchange(false)) {
+      referenced.push_back(page);
+      return false;
+    }
+    return true;
+  };
+  // the page cleaner keeps cold pages clean, reusing one of those costs no write
+  auto clean = [&evictable](Page *const &page) {
+    return !page->is_dirty_ && !page->is_flushing_ && evictable(page);
+  };
+  // the first round clears the reference bits, the second one finds a victim
+  // among them; a victim pinned just before it was claimed costs a round
+  for (int round = 0; round < 3 && p == nullptr; ++round) {
+    if (!(cleaner_running_ && replacer_->VictimIf(p, clean)) &&
+        !replacer_->VictimIf(p, evictable)) {
+      p = nullptr;
+    }
+    for (auto page : referenced) {
+      replacer_->Insert(page);
+    }
+    referenced.clear();
+    if (p != nullptr && !Claim(p)) {
+      replacer_->Insert(p);
+      p = nullptr;
+    }
+  }
+  if (p == nullptr) {
+    // every regular frame is pinned, take an idle one from the sequential ring
+    for (auto frame : ring_) {
+      if (frame != nullptr && !frame->is_flushing_ && Claim(frame)) {
+        p = frame;
+        LeaveRing(p);
+        break;
+      }
+    }
+  }
+  if (p == nullptr && num_retained_ > 0) {
+    // memory is short, retained pages have to compete again
+    ReleaseRetained();
+    return GetVictimPage();
+  }
+  if (p == nullptr) {
+    counters_.pin_failures.Add();
   }
   if (p != nullptr) {
-    assert(p->GetPinCount() == 0);  // the replaced page must be free from all threads
+    // only the cleaner's current page can be in flight, let its write finish
+    // before the frame is reused
+    while (p->is_flushing_) {
+      std::this_thread::yield();
+    }
   }
   return p;
 }
 
+/*
+ * the frame for a page that is about to be read in. With SEQUENTIAL access it
+ * comes from ring_: the frame in the slot under ring_hand_ is recycled when its
+ * page is no longer in use, otherwise (or while the ring fills up) a regular
+ * victim takes over the slot. Ring frames never enter the replacer. The frame
+ * is returned claimed. Caller must hold latch_
+ */
+Page *BufferPoolManager::GetFrame(AccessHint hint) {
+  if (hint != AccessHint::SEQUENTIAL || ring_.empty()) {
+    return GetVictimPage();
+  }
+  size_t slot = ring_hand_;
+  ring_hand_ = (ring_hand_ + 1) % ring_.size();
+  Page *p = ring_[slot];
+  if (p != nullptr && !p->is_flushing_ && Claim(p)) {
+    return p;
+  }
+  Page *victim = GetVictimPage();
+  if (victim == nullptr) {
+    return nullptr;
+  }
+  if (p != nullptr) {
+    // still in use, it becomes a regular frame
+    LeaveRing(p);
+    replacer_->Insert(p);
+  }
+  ring_[slot] = victim;
+  victim->in_ring_ = true;
+  return victim;
+}
+
+/*
+ * take p out of ring_. Caller must hold latch_
+ */
+void BufferPoolManager::LeaveRing(Page *p) {
+  if (!p->in_ring_) {
+    return;
+  }
+  std::replace(ring_.begin(), ring_.end(), p, static_cast<Page *>(nullptr));
+  p->in_ring_ = false;
+}
+
+/*
+ * write the victim frame p back if it is dirty, flushing the log first when
+ * the page is ahead of the persistent LSN (WAL), then hand the (now clean)
+ * page to the compressed cache if there is one. Every frame that is reused
+ * passes here, so this also counts the evictions. Caller must hold latch_
+ */
+void BufferPoolManager::WriteBackVictim(Page *p) {
+  if (p->GetPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  counters_.evictions.Add();
+  if (p->is_dirty_) {
+    if (ENABLE_LOGGING && log_manager_->GetPersistentLSN() < p->GetLSN()) {
+      counters_.eviction_log_flushes.Add();
+      log_manager_->Flush(true);
+    }
+    disk_manager_->WritePage(p->GetPageId(), p->data_);
+    counters_.dirty_writebacks.Add();
+    p->is_dirty_ = false;
+    if (cleaner_running_) {
+      // eviction had to write, the cleaner is falling behind
+      cleaner_cv_.notify_one();
+    }
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Insert(p->GetPageId(), p->data_);
+  }
+}
+
+/*
+ * read the content of page_id into data: out of the compressed cache if it is
+ * there, from disk otherwise
+ */
+void BufferPoolManager::ReadPageData(page_id_t page_id, char *data) {
+  if (compressed_cache_ == nullptr || !compressed_cache_->Take(page_id, data)) {
+    disk_manager_->ReadPage(page_id, data);
+  }
+}
+
+/*
+ * Put a compressed cache of capacity bytes behind the pool (all instances and
+ * regions share it). Not synchronized with FetchPage, so it must be called
+ * before the pool is used
+ */
+void BufferPoolManager::EnableCompressedCache(size_t capacity) {
+  if (compressed_cache_ != nullptr) {
+    return;
+  }
+  SetCompressedCache(new CompressedPageCache(capacity, page_size_));
+  owns_compressed_cache_ = true;
+}
+
+void BufferPoolManager::SetCompressedCache(CompressedPageCache *cache) {
+  compressed_cache_ = cache;
+  for (auto instance : instances_) {
+    instance->SetCompressedCache(cache);
+  }
+}
+
+/*
+ * Start the page cleaner: a background thread that wakes up every
+ * PAGE_CLEANER_TIMEOUT (or when an eviction had to write a dirty victim) and
+ * writes dirty, unpinned pages back until at least clean_fraction of the frames
+ * are clean. A partitioned pool starts one cleaner per instance
+ */
+void BufferPoolManager::RunPageCleaner(double clean_fraction) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      instance->RunPageCleaner(clean_fraction);
+    }
+    return;
+  }
+  if (cleaner_running_) {
+    return;
+  }
+  clean_fraction_ = clean_fraction;
+  cleaner_running_ = true;
+  cleaner_thread_ = new thread([&] {
+    while (cleaner_running_) {
+      {
+        unique_lock<mutex> lock(latch_);
+        cleaner_cv_.wait_for(lock, PAGE_CLEANER_TIMEOUT);
+      }
+      CleanPages();
+    }
+  });
+}
+
+/*
+ * Stop and join the page cleaner
+ */
+void BufferPoolManager::StopPageCleaner() {
+  for (auto instance : instances_) {
+    instance->StopPageCleaner();
+  }
+  if (!cleaner_running_) {
+    return;
+  }
+  {
+    auto lock = LockLatch();
+    cleaner_running_ = false;
+    cleaner_cv_.notify_one();
+  }
+  cleaner_thread_->join();
+  delete cleaner_thread_;
+  cleaner_thread_ = nullptr;
+}
+
+/*
+ * One round of the page cleaner. Up to CLEANER_BATCH_PAGES pages at a time
+ * are picked under latch_, going round the frames from cleaner_hand_, and
+ * written without it: each page is marked clean and is_flushing_ before the
+ * write, so an UnpinPage(dirty) during the write dirties it again, and
+ * GetVictimPage waits for the write instead of reusing the frame. The pages
+ * are copied out under their read latches, one at a time, and the copies are
+ * written with asynchronous I/O submitted together; no latch is held while
+ * the writes are in flight
+ * @return: number of pages written
+ */
+size_t BufferPoolManager::CleanPages() {
+  size_t written = 0;
+  std::vector<char> buffer(CLEANER_BATCH_PAGES * page_size_);
+  while (cleaner_running_) {
+    std::vector<Page *> batch;
+    std::vector<page_id_t> page_ids;
+    {
+      auto lock = LockLatch();
+      size_t dirty = 0;
+      for (size_t i = 0; i < capacity_; ++i) {
+        dirty += pages_[i].is_dirty_;
+      }
+      for (size_t i = 0; i < capacity_ && batch.size() < CLEANER_BATCH_PAGES &&
+                         dirty + clean_fraction_ * pool_size_ > pool_size_;
+           ++i) {
+        Page *candidate = &pages_[cleaner_hand_];
+        cleaner_hand_ = (cleaner_hand_ + 1) % capacity_;
+        if (candidate->is_dirty_ && candidate->pin_count_ == 0) {
+          batch.push_back(candidate);
+          page_ids.push_back(candidate->page_id_);
+          candidate->is_dirty_ = false;
+          candidate->is_flushing_ = true;
+          dirty--;
+        }
+      }
+    }
+    if (batch.empty()) {  // clean enough, or every dirty page is pinned
+      break;
+    }
+    lsn_t max_lsn = INVALID_LSN;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      batch[i]->RLatch();
+      memcpy(buffer.data() + i * page_size_, batch[i]->data_, page_size_);
+      max_lsn = std::max(max_lsn, batch[i]->GetLSN());
+      batch[i]->RUnlatch();
+    }
+    if (ENABLE_LOGGING && log_manager_->GetPersistentLSN() < max_lsn) {
+      log_manager_->Flush(true);
+    }
+    std::vector<std::future<bool>> writes;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      writes.push_back(disk_manager_->WritePageAsync(
+          page_ids[i], buffer.data() + i * page_size_));
+    }
+    disk_manager_->SubmitAsync();
+    for (size_t i = 0; i < batch.size(); ++i) {
+      writes[i].wait();
+      batch[i]->is_flushing_ = false;
+      counters_.cleaner_writebacks.Add();
+    }
+    written += batch.size();
+  }
+  return written;
+}
+
+/*
+ * Queue pages first, first + 1, ..., first + n - 1 for the prefetch reader
+ */
+void BufferPoolManager::Prefetch(page_id_t first, size_t n, AccessHint hint) {
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < n; ++i) {
+    page_ids.push_back(first + static_cast<page_id_t>(i));
+  }
+  Prefetch(page_ids, hint);
+}
+
+/*
+ * Queue page_ids for the prefetch reader and return right away; the reader
+ * thread is started on first use. Invalid ids are ignored, and so are pages
+ * that are resident already (one batched page table lookup) and requests
+ * beyond pool_size_ pending pages: those would evict each other anyway. hint
+ * chooses the frames as in FetchPage
+ */
+void BufferPoolManager::Prefetch(const std::vector<page_id_t> &page_ids,
+                                 AccessHint hint) {
+  if (!instances_.empty()) {
+    std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+    for (auto page_id : page_ids) {
+      if (page_id != INVALID_PAGE_ID) {
+        BufferPoolManager *instance = GetInstance(page_id);
+        for (size_t i = 0; i < instances_.size(); ++i) {
+          if (instances_[i] == instance) {
+            per_instance[i].push_back(page_id);
+            break;
+          }
+        }
+      }
+    }
+    for (size_t i = 0; i < instances_.size(); ++i) {
+      if (!per_instance[i].empty()) {
+        instances_[i]->Prefetch(per_instance[i], hint);
+      }
+    }
+    return;
+  }
+  std::vector<Page *> frames;
+  std::vector<bool> resident;
+  page_table_->FindBatch(page_ids, frames, resident);
+  lock_guard<mutex> lock(prefetch_latch_);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (page_ids[i] != INVALID_PAGE_ID && !resident[i] &&
+        prefetch_queue_.size() < pool_size_) {
+      prefetch_queue_.emplace_back(page_ids[i], hint);
+    }
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_thread_ = new thread([&] {
+      unique_lock<mutex> latch(prefetch_latch_);
+      while (true) {
+        prefetch_cv_.wait(latch, [&] {
+          return prefetch_stop_ || !prefetch_queue_.empty();
+        });
+        if (prefetch_stop_) {
+          return;
+        }
+        std::vector<std::pair<page_id_t, AccessHint>> requests;
+        while (!prefetch_queue_.empty() &&
+               requests.size() < PREFETCH_BATCH_PAGES) {
+          requests.push_back(prefetch_queue_.front());
+          prefetch_queue_.pop_front();
+        }
+        latch.unlock();
+        LoadPages(requests);
+        latch.lock();
+      }
+    });
+  }
+  prefetch_cv_.notify_one();
+}
+
+/*
+ * Prefetch reader: read the requested pages that are not resident into frames.
+ * Each frame stays pinned and is_loading_ while its read runs without latch_,
+ * so eviction cannot take it and FetchPage waits for the data. The reads are
+ * submitted together and each frame is let go as soon as its own read is
+ * done; this returns when all of them are. If every frame is pinned the
+ * remaining pages are skipped
+ */
+void BufferPoolManager::LoadPages(
+    const std::vector<std::pair<page_id_t, AccessHint>> &requests) {
+  std::vector<Page *> loading;
+  for (auto &request : requests) {
+    page_id_t page_id = request.first;
+    Page *p = nullptr;
+    {
+      auto lock = LockLatch();
+      if (page_table_->Find(page_id, p)) {
+        continue;
+      }
+      p = GetFrame(request.second);
+      if (p == nullptr) {
+        break;
+      }
+      WriteBackVictim(p);
+      page_table_->Remove(p->GetPageId());
+      page_table_->Insert(page_id, p);
+      replacer_->Load(p, page_id);
+      if (!p->in_ring_) {
+        replacer_->Insert(p);
+      }
+      p->is_dirty_ = false;
+      p->access_stamp_ = AccessStamp();
+      p->page_id_ = page_id;
+      p->is_loading_ = true;
+      p->pin_count_ = 1;
+    }
+    if (compressed_cache_ != nullptr &&
+        compressed_cache_->Take(page_id, p->data_)) {
+      p->is_loading_ = false;
+      UnpinFrame(p, false);
+    } else {
+      loading.push_back(p);
+    }
+  }
+  if (loading.empty()) {
+    return;
+  }
+  size_t pending = loading.size();
+  mutex done_latch;  // protects pending
+  std::condition_variable done_cv;
+  for (Page *p : loading) {
+    disk_manager_->ReadPageAsync(p->page_id_, p->data_, [&, p](bool) {
+      p->is_loading_ = false;
+      UnpinFrame(p, false);
+      lock_guard<mutex> lock(done_latch);
+      if (--pending == 0) {
+        done_cv.notify_one();
+      }
+    });
+  }
+  disk_manager_->SubmitAsync();
+  unique_lock<mutex> lock(done_latch);
+  done_cv.wait(lock, [&] { return pending == 0; });
+}
+
+/*
+ * Write the ids of the resident pages, most recently used first, to file_name:
+ * a uint32_t count followed by the page ids. The list goes to a temporary file
+ * that then replaces file_name, so a crash never leaves half a list behind
+ * @return: false if the file cannot be written
+ */
+bool BufferPoolManager::SaveResidentPages(const std::string &file_name) {
+  if (has_regions_) {
+    // one list per region, to warm each region up with its own pages
+    bool saved = true;
+    for (size_t i = 0; i < instances_.size(); ++i) {
+      saved = instances_[i]->SaveResidentPages(
+                  file_name + "." + std::to_string(i)) && saved;
+    }
+    return saved;
+  }
+  std::vector<std::pair<int64_t, page_id_t>> resident;
+  CollectResidentPages(resident);
+  std::sort(resident.begin(), resident.end(),
+            std::greater<std::pair<int64_t, page_id_t>>());
+  std::vector<page_id_t> page_ids;
+  for (auto &entry : resident) {
+    page_ids.push_back(entry.second);
+  }
+
+  std::string tmp_name = file_name + ".tmp";
+  std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+  uint32_t count = page_ids.size();
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  out.write(reinterpret_cast<const char *>(page_ids.data()),
+            page_ids.size() * sizeof(page_id_t));
+  out.close();
+  if (!out) {
+    remove(tmp_name.c_str());
+    return false;
+  }
+  return rename(tmp_name.c_str(), file_name.c_str()) == 0;
+}
+
+/*
+ * Read the pages listed by SaveResidentPages back into the pool, as far as they
+ * fit into free (or evictable) frames, most recently used first. They are read
+ * in page id order, each run of consecutive ids (up to WARM_UP_BATCH_PAGES)
+ * with one DiskManager::ReadPages, and only then handed to the replacer, least
+ * recently used first, so that the replacer starts with the old recency order.
+ * Meant to run before the pool is used; a missing or damaged file loads
+ * nothing, and pages beyond the end of the db file (the list outlived the
+ * file it was saved for) are left out
+ * @return: number of pages read in
+ */
+size_t BufferPoolManager::WarmUp(const std::string &file_name) {
+  if (has_regions_) {
+    size_t num_pages = 0;
+    for (size_t i = 0; i < instances_.size(); ++i) {
+      num_pages += instances_[i]->WarmUp(file_name + "." + std::to_string(i));
+    }
+    return num_pages;
+  }
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  std::vector<page_id_t> page_ids(count);
+  in.read(reinterpret_cast<char *>(page_ids.data()),
+          page_ids.size() * sizeof(page_id_t));
+  if (!in) {
+    return 0;
+  }
+  const page_id_t num_pages = disk_manager_->GetNumPages();
+  page_ids.erase(std::remove_if(page_ids.begin(), page_ids.end(),
+                                [num_pages](page_id_t page_id) {
+                                  return page_id < 0 || page_id >= num_pages;
+                                }),
+                 page_ids.end());
+  if (page_ids.size() > pool_size_) {
+    page_ids.resize(pool_size_);
+  }
+
+  std::vector<page_id_t> sorted(page_ids);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  std::vector<char> buffer(WARM_UP_BATCH_PAGES * page_size_);
+  std::unordered_map<page_id_t, Page *> installed;
+  size_t i = 0;
+  while (i < sorted.size()) {
+    size_t run = 1;
+    while (i + run < sorted.size() && run < WARM_UP_BATCH_PAGES &&
+           sorted[i + run] == sorted[i] + static_cast<page_id_t>(run)) {
+      run++;
+    }
+    disk_manager_->ReadPages(sorted[i], buffer.data(), run);
+    for (size_t j = 0; j < run; ++j) {
+      page_id_t page_id = sorted[i + j];
+      Page *p = InstallPage(page_id, buffer.data() + j * page_size_);
+      if (p != nullptr) {
+        installed[page_id] = p;
+      }
+    }
+    i += run;
+  }
+
+  // least recently used first
+  std::vector<std::pair<page_id_t, Page *>> admit;
+  for (auto it = page_ids.rbegin(); it != page_ids.rend(); ++it) {
+    auto entry = installed.find(*it);
+    if (entry != installed.end()) {
+      admit.emplace_back(entry->first, entry->second);
+      installed.erase(entry);
+    }
+  }
+  AdmitPages(admit);
+  return admit.size();
+}
+
+/*
+ * Start a background thread that saves the resident page list to file_name
+ * every WARM_UP_SAVE_TIMEOUT, and once more when it is stopped
+ */
+void BufferPoolManager::RunResidentPageSaver(const std::string &file_name) {
+  lock_guard<mutex> lock(saver_latch_);
+  if (saver_running_) {
+    return;
+  }
+  saver_file_ = file_name;
+  saver_running_ = true;
+  saver_thread_ = new thread([&] {
+    unique_lock<mutex> latch(saver_latch_);
+    do {
+      saver_cv_.wait_for(latch, WARM_UP_SAVE_TIMEOUT,
+                         [&] { return !saver_running_; });
+      latch.unlock();
+      SaveResidentPages(saver_file_);
+      latch.lock();
+    } while (saver_running_);
+  });
+}
+
+/*
+ * Stop and join the resident page saver, which saves the list a last time
+ */
+void BufferPoolManager::StopResidentPageSaver() {
+  {
+    lock_guard<mutex> lock(saver_latch_);
+    if (!saver_running_) {
+      return;
+    }
+    saver_running_ = false;
+    saver_cv_.notify_one();
+  }
+  saver_thread_->join();
+  delete saver_thread_;
+  saver_thread_ = nullptr;
+}
+
+/*
+ * Append (access stamp, page id) of every resident page of this instance
+ */
+void BufferPoolManager::CollectResidentPages(
+    std::vector<std::pair<int64_t, page_id_t>> &resident) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      instance->CollectResidentPages(resident);
+    }
+    return;
+  }
+  auto lock = LockLatch();
+  for (size_t i = 0; i < capacity_; ++i) {
+    Page *p = &pages_[i];
+    if (p->page_id_ != INVALID_PAGE_ID) {
+      resident.emplace_back(p->access_stamp_.load(), p->page_id_.load());
+    }
+  }
+}
+
+/*
+ * Put page_id with the given content into a frame, unpinned, unless it is
+ * resident already. The frame is left out of the replacer until AdmitPages,
+ * so warm-up cannot evict the pages it has just read
+ * @return: the frame, nullptr if there is no frame left or page_id was resident
+ */
+Page *BufferPoolManager::InstallPage(page_id_t page_id, const char *data) {
+  if (!instances_.empty()) {
+    return GetInstance(page_id)->InstallPage(page_id, data);
+  }
+  auto lock = LockLatch();
+  Page *p = nullptr;
+  if (page_table_->Find(page_id, p)) {
+    return nullptr;
+  }
+  p = GetVictimPage();
+  if (p == nullptr) {
+    return p;
+  }
+  WriteBackVictim(p);
+  page_table_->Remove(p->GetPageId());
+  page_table_->Insert(page_id, p);
+  replacer_->Load(p, page_id);
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  memcpy(p->data_, data, page_size_);
+  p->is_dirty_ = false;
+  p->page_id_ = page_id;
+  p->pin_count_ = 0;  // ends the claim
+  return p;
+}
+
+/*
+ * Hand the frames of this instance among pages to the replacer, in order,
+ * unless they were reused meanwhile
+ */
+void BufferPoolManager::AdmitPages(
+    const std::vector<std::pair<page_id_t, Page *>> &pages) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      instance->AdmitPages(pages);
+    }
+    return;
+  }
+  auto lock = LockLatch();
+  for (auto &entry : pages) {
+    Page *p = entry.second;
+    if (p < pages_ || p >= pages_ + capacity_ || p->page_id_ != entry.first) {
+      continue;
+    }
+    p->access_stamp_ = AccessStamp();
+    replacer_->Insert(p);
+  }
+}
+
+/*
+ * fraction of FetchPage calls that found the page in the pool, summed over all
+ * instances of a partitioned pool
+ */
+double BufferPoolManager::GetHitRatio() { return GetStats().GetHitRatio(); }
+
+/*
+ * snapshot of the counters, summed over all instances of a partitioned pool.
+ * The dirty page count is taken by looking at every frame
+ */
+BufferPoolStats BufferPoolManager::GetStats() {
+  BufferPoolStats stats = counters_.Snapshot();
+  for (size_t i = 0; i < capacity_; ++i) {
+    stats.dirty_pages += pages_[i].is_dirty_;
+  }
+  stats.pool_frames = num_online_;
+  for (auto instance : instances_) {
+    stats += instance->GetStats();
+  }
+  if (owns_compressed_cache_) {
+    stats.compressed_hits = compressed_cache_->GetHits();
+    stats.compressed_misses = compressed_cache_->GetMisses();
+    stats.compressed_pages = compressed_cache_->GetNumPages();
+    stats.compressed_bytes = compressed_cache_->GetBytes();
+  }
+  return stats;
+}
+
+/*
+ * Pin page (which the caller has pinned) once more on behalf of the pool, so
+ * that it stays resident after the caller unpins it, e.g. the upper levels of a
+ * B+tree. At most half of the frames are retained, and all retained pages are
+ * let go when an eviction finds no other victim. DeletePage drops the pin
+ * @return: true if the page is retained
+ */
+bool BufferPoolManager::Retain(Page *page) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      if (instance->OwnsFrame(page)) {
+        return instance->Retain(page);
+      }
+    }
+    return false;
+  }
+  if (page->is_retained_) {
+    return true;
+  }
+  auto lock = LockLatch();
+  if (page->is_retained_) {
+    return true;
+  }
+  if (page->pin_count_ <= 0 || 2 * (num_retained_ + 1) > pool_size_) {
+    return false;
+  }
+  page->pin_count_++;
+  page->is_retained_ = true;
+  num_retained_++;
+  return true;
+}
+
+/*
+ * drop the pins of all retained pages. Caller must hold latch_
+ */
+void BufferPoolManager::ReleaseRetained() {
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (pages_[i].is_retained_) {
+      pages_[i].is_retained_ = false;
+      pages_[i].pin_count_--;
+    }
+  }
+  num_retained_ = 0;
+}
+
+/*
+ * number of frames of the pool, the sum over its instances or regions
+ */
+size_t BufferPoolManager::GetPoolSize() {
+  if (!instances_.empty()) {
+    size_t pool_size = 0;
+    for (auto instance : instances_) {
+      pool_size += instance->GetPoolSize();
+    }
+    return pool_size;
+  }
+  return pool_size_;
+}
+
+/*
+ * Change the number of frames to pool_size, at most the number the pool was
+ * constructed with. Growing brings offline frames back right away. Shrinking
+ * takes the free frames above pool_size offline right away and leaves the
+ * frames in use to the shrinker thread, which takes them offline as they
+ * become unpinned. A partitioned pool splits pool_size over its instances like
+ * the constructor does; a pool with regions is resized region by region,
+ * through GetRegion
+ * @return: false if pool_size is 0 or beyond the capacity
+ */
+bool BufferPoolManager::Resize(size_t pool_size) {
+  if (has_regions_ || pool_size == 0) {
+    return false;
+  }
+  if (!instances_.empty()) {
+    size_t num_instances = instances_.size();
+    for (size_t i = 0; i < num_instances; ++i) {
+      size_t instance_size = pool_size / num_instances +
+          (i < pool_size % num_instances ? 1 : 0);
+      if (instance_size == 0 || instance_size > instances_[i]->capacity_) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i < num_instances; ++i) {
+      instances_[i]->Resize(pool_size / num_instances +
+                            (i < pool_size % num_instances ? 1 : 0));
+    }
+    pool_size_ = pool_size;
+    return true;
+  }
+  if (pool_size > capacity_) {
+    return false;
+  }
+  {
+    auto lock = LockLatch();
+    if (pool_size >= pool_size_) {
+      for (size_t i = pool_size_; i < pool_size; ++i) {
+        if (offline_[i]) {
+          offline_[i] = false;
+          num_online_++;
+          pages_[i].pin_count_ = 0;  // ends the claim
+          free_list_->push_back(&pages_[i]);
+        }
+      }
+      if (pool_size > pool_size_) {
+        counters_.pool_grows.Add();
+      }
+      pool_size_ = pool_size;
+      return true;
+    }
+    counters_.pool_shrinks.Add();
+    pool_size_ = pool_size;
+    std::vector<Page *> free_frames;
+    for (auto p : *free_list_) {
+      if (static_cast<size_t>(p - pages_) >= pool_size_) {
+        free_frames.push_back(p);
+      }
+    }
+    for (auto p : free_frames) {
+      OfflineFrame(p);
+    }
+  }
+  {
+    lock_guard<mutex> lock(shrink_latch_);
+    shrink_pending_ = true;
+    if (shrink_thread_ == nullptr) {
+      shrink_thread_ = new thread([&] {
+        unique_lock<mutex> latch(shrink_latch_);
+        while (true) {
+          shrink_cv_.wait(latch,
+                          [&] { return shrink_stop_ || shrink_pending_; });
+          if (shrink_stop_) {
+            return;
+          }
+          shrink_pending_ = false;
+          latch.unlock();
+          bool done = ShrinkFrames();
+          latch.lock();
+          if (!done) {
+            // some frames are pinned, look again in a while
+            shrink_cv_.wait_for(latch, SHRINK_RETRY_TIMEOUT,
+                                [&] { return shrink_stop_; });
+            shrink_pending_ = true;
+          }
+        }
+      });
+    }
+  }
+  shrink_cv_.notify_one();
+  return true;
+}
+
+/*
+ * One pass of the shrinker over the frames above pool_size_, from the top.
+ * latch_ is taken per frame, so FetchPage misses get in between. Once all of
+ * them are offline their memory goes back to the OS
+ * @return: true if every frame above pool_size_ is offline
+ */
+bool BufferPoolManager::ShrinkFrames() {
+  bool done = true;
+  for (size_t i = capacity_; i-- > 0;) {
+    auto lock = LockLatch();
+    if (i < pool_size_) {
+      break;
+    }
+    if (!offline_[i] && !OfflineFrame(&pages_[i])) {
+      done = false;
+    }
+  }
+  if (done) {
+    // only the offline frames at the top, a shrink may have come in meanwhile
+    auto lock = LockLatch();
+    size_t first = capacity_;
+    while (first > 0 && offline_[first - 1]) {
+      first--;
+    }
+    frame_arena_.Discard(first * page_size_, (capacity_ - first) * page_size_);
+  }
+  return done;
+}
+
+/*
+ * Take frame p offline for a shrink. A retained page is let go first. The page
+ * of an unpinned frame moves to a free frame below pool_size_ if there is one
+ * and is evicted otherwise. An offline frame stays claimed, so TryPin and
+ * GetVictimPage never take it. Caller must hold latch_
+ * @return: false if the frame is in use
+ */
+bool BufferPoolManager::OfflineFrame(Page *p) {
+  if (p->is_flushing_) {
+    return false;
+  }
+  if (p->is_retained_ && p->pin_count_ == 1) {
+    p->is_retained_ = false;
+    p->pin_count_--;
+    num_retained_--;
+  }
+  if (!Claim(p)) {
+    return false;
+  }
+  replacer_->Erase(p);
+  LeaveRing(p);
+  page_id_t page_id = p->page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    free_list_->remove(p);  // DeletePage may have freed it after the resize
+  } else {
+    auto free = std::find_if(
+        free_list_->begin(), free_list_->end(), [this](Page *frame) {
+          return static_cast<size_t>(frame - pages_) < pool_size_;
+        });
+    if (free != free_list_->end()) {
+      Page *frame = *free;
+      free_list_->erase(free);
+      while (!Claim(frame)) {  // see GetVictimPage
+        std::this_thread::yield();
+      }
+      memcpy(frame->data_, p->data_, page_size_);
+      frame->is_dirty_ = p->is_dirty_.load();
+      frame->access_stamp_ = p->access_stamp_.load();
+      frame->page_id_ = page_id;
+      page_table_->Insert(page_id, frame);
+      replacer_->Load(frame, page_id);
+      replacer_->Insert(frame);
+      frame->pin_count_ = 0;  // ends the claim
+      counters_.shrink_migrations.Add();
+    } else {
+      WriteBackVictim(p);
+      page_table_->Remove(page_id);
+      counters_.shrink_evictions.Add();
+    }
+  }
+  p->page_id_ = INVALID_PAGE_ID;
+  p->is_dirty_ = false;
+  p->is_referenced_ = false;
+  offline_[p - pages_] = true;
+  num_online_--;
+  return true;
+}
+
 //DEBUG
 bool BufferPoolManager::CheckAllUnpined() {
   bool res = true;
-  for (size_t i = 1; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+  if (!instances_.empty()) {
+    for (auto instance : instances_) {
+      res = instance->CheckAllUnpined() && res;
+    }
+    return res;
+  }
+  for (size_t i = 1; i < capacity_; i++) {
+    if (offline_[i]) {
+      continue;
+    }
+    if (pages_[i].pin_count_ != (pages_[i].is_retained_ ? 1 : 0)) {
       res = false;
       std::cout << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
     }
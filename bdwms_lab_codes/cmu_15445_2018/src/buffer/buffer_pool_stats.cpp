@@ -0,0 +1,192 @@
+/**
+ * buffer_pool_stats.cpp
+ */
+
+#include <sstream>
+
+#include "buffer/buffer_pool_stats.h"
+
+namespace cmudb {
+
+/*
+ * the stripe of the calling thread; threads are numbered in the order they
+ * first touch any counter, so up to STATS_STRIPES threads never share one
+ */
+size_t StripedCounter::ThreadStripe() {
+  static std::atomic<size_t> next_thread{0};
+  thread_local size_t stripe = next_thread++ % STATS_STRIPES;
+  return stripe;
+}
+
+uint64_t StripedCounter::Load() const {
+  uint64_t sum = 0;
+  for (auto &stripe : stripes_) {
+    sum += stripe.value.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+void BufferPoolCounters::RecordLatchWait(
+    std::chrono::steady_clock::duration wait) {
+  uint64_t us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(wait).count());
+  size_t bucket = 0;
+  while (bucket + 1 < LATCH_WAIT_BUCKETS && (us >> bucket) != 0) {
+    bucket++;
+  }
+  latch_waits_.fetch_add(1, std::memory_order_relaxed);
+  latch_wait_us_.fetch_add(us, std::memory_order_relaxed);
+  latch_wait_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+ * read all counters; they are not read atomically together, so a snapshot
+ * taken under load may be off by the operations running meanwhile
+ */
+BufferPoolStats BufferPoolCounters::Snapshot() const {
+  BufferPoolStats stats;
+  stats.fetch_hits = fetch_hits.Load();
+  stats.fetch_misses = fetch_misses.Load();
+  stats.evictions = evictions.Load();
+  stats.dirty_writebacks = dirty_writebacks.Load();
+  stats.cleaner_writebacks = cleaner_writebacks.Load();
+  stats.flushed_pages = flushed_pages.Load();
+  stats.eviction_log_flushes = eviction_log_flushes.Load();
+  stats.pin_failures = pin_failures.Load();
+  stats.latch_acquisitions = latch_acquisitions.Load();
+  stats.pool_grows = pool_grows.Load();
+  stats.pool_shrinks = pool_shrinks.Load();
+  stats.shrink_migrations = shrink_migrations.Load();
+  stats.shrink_evictions = shrink_evictions.Load();
+  stats.latch_waits = latch_waits_.load(std::memory_order_relaxed);
+  stats.latch_wait_us = latch_wait_us_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < LATCH_WAIT_BUCKETS; ++i) {
+    stats.latch_wait_histogram[i] =
+        latch_wait_histogram_[i].load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+/*
+ * fraction of FetchPage calls that found the page in the pool
+ */
+double BufferPoolStats::GetHitRatio() const {
+  if (fetch_hits + fetch_misses == 0) {
+    return 0;
+  }
+  return static_cast<double>(fetch_hits) / (fetch_hits + fetch_misses);
+}
+
+/*
+ * fraction of the reads of a FetchPage miss that the compressed cache served
+ */
+double BufferPoolStats::GetCompressedHitRatio() const {
+  if (compressed_hits + compressed_misses == 0) {
+    return 0;
+  }
+  return static_cast<double>(compressed_hits) /
+      (compressed_hits + compressed_misses);
+}
+
+BufferPoolStats &BufferPoolStats::operator+=(const BufferPoolStats &other) {
+  fetch_hits += other.fetch_hits;
+  fetch_misses += other.fetch_misses;
+  evictions += other.evictions;
+  dirty_writebacks += other.dirty_writebacks;
+  cleaner_writebacks += other.cleaner_writebacks;
+  flushed_pages += other.flushed_pages;
+  eviction_log_flushes += other.eviction_log_flushes;
+  pin_failures += other.pin_failures;
+  dirty_pages += other.dirty_pages;
+  pool_frames += other.pool_frames;
+  pool_grows += other.pool_grows;
+  pool_shrinks += other.pool_shrinks;
+  shrink_migrations += other.shrink_migrations;
+  shrink_evictions += other.shrink_evictions;
+  latch_acquisitions += other.latch_acquisitions;
+  latch_waits += other.latch_waits;
+  latch_wait_us += other.latch_wait_us;
+  for (size_t i = 0; i < LATCH_WAIT_BUCKETS; ++i) {
+    latch_wait_histogram[i] += other.latch_wait_histogram[i];
+  }
+  compressed_hits += other.compressed_hits;
+  compressed_misses += other.compressed_misses;
+  compressed_pages += other.compressed_pages;
+  compressed_bytes += other.compressed_bytes;
+  return *this;
+}
+
+/*
+ * one "name value" pair per line; histogram buckets are named by their upper
+ * bound in microseconds
+ */
+std::string BufferPoolStats::ToString() const {
+  std::ostringstream os;
+  os << "fetch_hits " << fetch_hits << "\n"
+     << "fetch_misses " << fetch_misses << "\n"
+     << "hit_ratio " << GetHitRatio() << "\n"
+     << "evictions " << evictions << "\n"
+     << "dirty_writebacks " << dirty_writebacks << "\n"
+     << "cleaner_writebacks " << cleaner_writebacks << "\n"
+     << "flushed_pages " << flushed_pages << "\n"
+     << "eviction_log_flushes " << eviction_log_flushes << "\n"
+     << "pin_failures " << pin_failures << "\n"
+     << "dirty_pages " << dirty_pages << "\n"
+     << "pool_frames " << pool_frames << "\n"
+     << "pool_grows " << pool_grows << "\n"
+     << "pool_shrinks " << pool_shrinks << "\n"
+     << "shrink_migrations " << shrink_migrations << "\n"
+     << "shrink_evictions " << shrink_evictions << "\n"
+     << "latch_acquisitions " << latch_acquisitions << "\n"
+     << "latch_waits " << latch_waits << "\n"
+     << "latch_wait_us " << latch_wait_us << "\n";
+  for (size_t i = 0; i < LATCH_WAIT_BUCKETS; ++i) {
+    os << "latch_wait_lt_";
+    if (i + 1 < LATCH_WAIT_BUCKETS) {
+      os << (1ULL << i) << "us ";
+    } else {
+      os << "inf ";
+    }
+    os << latch_wait_histogram[i] << "\n";
+  }
+  os << "compressed_hits " << compressed_hits << "\n"
+     << "compressed_misses " << compressed_misses << "\n"
+     << "compressed_hit_ratio " << GetCompressedHitRatio() << "\n"
+     << "compressed_pages " << compressed_pages << "\n"
+     << "compressed_bytes " << compressed_bytes << "\n";
+  return os.str();
+}
+
+std::string BufferPoolStats::ToJson() const {
+  std::ostringstream os;
+  os << "{\"fetch_hits\":" << fetch_hits
+     << ",\"fetch_misses\":" << fetch_misses
+     << ",\"hit_ratio\":" << GetHitRatio()
+     << ",\"evictions\":" << evictions
+     << ",\"dirty_writebacks\":" << dirty_writebacks
+     << ",\"cleaner_writebacks\":" << cleaner_writebacks
+     << ",\"flushed_pages\":" << flushed_pages
+     << ",\"eviction_log_flushes\":" << eviction_log_flushes
+     << ",\"pin_failures\":" << pin_failures
+     << ",\"dirty_pages\":" << dirty_pages
+     << ",\"pool_frames\":" << pool_frames
+     << ",\"pool_grows\":" << pool_grows
+     << ",\"pool_shrinks\":" << pool_shrinks
+     << ",\"shrink_migrations\":" << shrink_migrations
+     << ",\"shrink_evictions\":" << shrink_evictions
+     << ",\"latch_acquisitions\":" << latch_acquisitions
+     << ",\"latch_waits\":" << latch_waits
+     << ",\"latch_wait_us\":" << latch_wait_us
+     << ",\"latch_wait_histogram\":[";
+  for (size_t i = 0; i < LATCH_WAIT_BUCKETS; ++i) {
+    os << (i == 0 ? "" : ",") << latch_wait_histogram[i];
+  }
+  os << "],\"compressed_hits\":" << compressed_hits
+     << ",\"compressed_misses\":" << compressed_misses
+     << ",\"compressed_hit_ratio\":" << GetCompressedHitRatio()
+     << ",\"compressed_pages\":" << compressed_pages
+     << ",\"compressed_bytes\":" << compressed_bytes << "}";
+  return os.str();
+}
+
+} // namespace cmudb
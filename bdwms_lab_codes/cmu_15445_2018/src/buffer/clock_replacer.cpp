@@ -0,0 +1,127 @@
+/**
+ * CLOCK implementation
+ */
+#include <cassert>
+
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+ClockReplacer<T>::ClockReplacer(size_t num_frames, T first_frame)
+    : first_frame_(first_frame), num_frames_(num_frames),
+      in_replacer_(num_frames, 0), ref_bit_(num_frames, 0) {}
+
+template <typename T> ClockReplacer<T>::~ClockReplacer() {}
+
+/*
+ * Mark the frame evictable and give it a second chance
+ */
+template <typename T> void ClockReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  size_t frame_id = FrameId(value);
+  assert(frame_id < num_frames_);
+  if (!in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = 1;
+    size_++;
+  }
+  ref_bit_[frame_id] = 1;
+}
+
+/*
+ * Advance the clock hand until an evictable frame with a cleared reference bit
+ * is found, clearing the reference bits passed on the way. Return false if
+ * there is no evictable frame
+ */
+template <typename T> bool ClockReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // with an evictable frame around, two full sweeps always end on one
+  return Sweep(value, nullptr, 2 * num_frames_);
+}
+
+/*
+ * Same sweep, but frames that prefer rejects are passed over. Two full sweeps
+ * clear every reference bit, so an accepted frame is found within them if there
+ * is one; otherwise fall back to the plain victim
+ */
+template <typename T>
+bool ClockReplacer<T>::PreferredVictim(
+    T &value, const std::function<bool(const T &)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  return Sweep(value, prefer, 2 * num_frames_) ||
+         Sweep(value, nullptr, 2 * num_frames_);
+}
+
+/*
+ * Same sweep, restricted to frames that accept accepts
+ */
+template <typename T>
+bool ClockReplacer<T>::VictimIf(
+    T &value, const std::function<bool(const T &)> &accept) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  return Sweep(value, accept, 2 * num_frames_);
+}
+
+/*
+ * Advance the hand at most max_steps frames. Caller must hold latch_
+ */
+template <typename T>
+bool ClockReplacer<T>::Sweep(T &value,
+                             const std::function<bool(const T &)> &prefer,
+                             size_t max_steps) {
+  for (size_t step = 0; step < max_steps; ++step) {
+    size_t frame_id = hand_;
+    hand_ = (hand_ + 1) % num_frames_;
+    if (!in_replacer_[frame_id]) {
+      continue;
+    }
+    if (ref_bit_[frame_id]) {
+      ref_bit_[frame_id] = 0;
+      continue;
+    }
+    if (prefer && !prefer(first_frame_ + frame_id)) {
+      continue;
+    }
+    in_replacer_[frame_id] = 0;
+    size_--;
+    value = first_frame_ + frame_id;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * The frame got pinned, it is no longer a candidate for eviction
+ */
+template <typename T> bool ClockReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  size_t frame_id = FrameId(value);
+  if (frame_id >= num_frames_ || !in_replacer_[frame_id]) {
+    return false;
+  }
+  in_replacer_[frame_id] = 0;
+  ref_bit_[frame_id] = 0;
+  size_--;
+  return true;
+}
+
+template <typename T> size_t ClockReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return size_;
+}
+
+template class ClockReplacer<Page *>;
+// test only
+template class ClockReplacer<int>;
+
+} // namespace cmudb
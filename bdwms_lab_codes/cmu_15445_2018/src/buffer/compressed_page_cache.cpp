@@ -0,0 +1,106 @@
+/**
+ * compressed_page_cache.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+#include "buffer/compressed_page_cache.h"
+#include "common/lz_codec.h"
+
+namespace cmudb {
+
+CompressedPageCache::CompressedPageCache(size_t capacity, size_t page_size)
+    : capacity_(capacity), page_size_(page_size) {}
+
+/*
+ * The page is compressed before latch_ is taken. An older copy of page_id is
+ * replaced, and the oldest pages are dropped until the new one fits
+ */
+void CompressedPageCache::Insert(page_id_t page_id, const char *data) {
+  std::vector<char> compressed(page_size_);
+  size_t size =
+      LZCodec::Compress(data, page_size_, compressed.data(), page_size_ - 1);
+  if (size == 0) {
+    memcpy(compressed.data(), data, page_size_);
+    size = page_size_;
+  }
+  if (size > capacity_) {
+    Erase(page_id);
+    return;
+  }
+  compressed.resize(size);
+  compressed.shrink_to_fit();
+
+  std::lock_guard<std::mutex> lock(latch_);
+  auto found = index_.find(page_id);
+  if (found != index_.end()) {
+    EraseEntry(found->second);
+  }
+  while (bytes_ + size > capacity_) {
+    EraseEntry(std::prev(entries_.end()));
+  }
+  entries_.push_front(Entry{page_id, std::move(compressed)});
+  index_[page_id] = entries_.begin();
+  bytes_ += size;
+}
+
+/*
+ * decompression runs after latch_ is released, the entry is already out of
+ * the cache by then
+ */
+bool CompressedPageCache::Take(page_id_t page_id, char *data) {
+  std::vector<char> compressed;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    auto found = index_.find(page_id);
+    if (found == index_.end()) {
+      misses_++;
+      return false;
+    }
+    auto it = found->second;
+    compressed = std::move(it->data);
+    bytes_ -= compressed.size();
+    index_.erase(found);
+    entries_.erase(it);
+  }
+  hits_++;
+  if (compressed.size() == page_size_) {
+    memcpy(data, compressed.data(), page_size_);
+    return true;
+  }
+  bool decompressed = LZCodec::Decompress(compressed.data(), compressed.size(),
+                                          data, page_size_);
+  assert(decompressed);
+  return decompressed;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto found = index_.find(page_id);
+  if (found != index_.end()) {
+    EraseEntry(found->second);
+  }
+}
+
+size_t CompressedPageCache::GetNumPages() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return entries_.size();
+}
+
+size_t CompressedPageCache::GetBytes() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return bytes_;
+}
+
+/*
+ * Caller must hold latch_
+ */
+void CompressedPageCache::EraseEntry(std::list<Entry>::iterator it) {
+  bytes_ -= it->data.size();
+  index_.erase(it->page_id);
+  entries_.erase(it);
+}
+
+} // namespace cmudb
@@ -0,0 +1,81 @@
+/**
+ * frame_arena.cpp
+ */
+
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "buffer/frame_arena.h"
+
+namespace cmudb {
+
+/*
+ * Map size bytes of zeroed memory. Arenas of at least one huge page are
+ * rounded up to and aligned on HUGE_PAGE_SIZE so that the kernel can back all
+ * of them with huge pages; smaller ones are only aligned on the OS page.
+ * Throws std::bad_alloc, like new, if the memory cannot be mapped
+ */
+FrameArena::FrameArena(size_t size, bool prefault)
+    : size_(size), mapped_size_(0) {
+  if (size_ == 0) {
+    return;
+  }
+  const size_t os_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const bool huge = size_ >= HUGE_PAGE_SIZE;
+  const size_t align = huge ? HUGE_PAGE_SIZE : os_page;
+  mapped_size_ = (size_ + align - 1) / align * align;
+
+  // over-map by one alignment unit and trim both ends to get the alignment
+  size_t raw_size = huge ? mapped_size_ + align : mapped_size_;
+  void *raw = mmap(nullptr, raw_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  char *start = static_cast<char *>(raw);
+  if (huge) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(start);
+    char *aligned = start + (align - addr % align) % align;
+    if (aligned > start) {
+      munmap(start, aligned - start);
+    }
+    char *end = aligned + mapped_size_;
+    if (start + raw_size > end) {
+      munmap(end, start + raw_size - end);
+    }
+    start = aligned;
+#ifdef MADV_HUGEPAGE
+    huge_page_advised_ = madvise(start, mapped_size_, MADV_HUGEPAGE) == 0;
+#endif
+  }
+  data_ = start;
+
+  if (prefault) {
+    // write, not read: reading would only map the shared zero page. Touch
+    // every OS page in case the kernel could not find a free huge page
+    for (size_t off = 0; off < mapped_size_; off += os_page) {
+      volatile char *p = data_ + off;
+      *p = 0;
+    }
+  }
+}
+
+void FrameArena::Discard(size_t offset, size_t size) {
+  const size_t os_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = (offset + os_page - 1) / os_page * os_page;
+  size_t end = (offset + size) / os_page * os_page;
+  if (data_ == nullptr || begin >= end) {
+    return;
+  }
+  madvise(data_ + begin, end - begin, MADV_DONTNEED);
+}
+
+FrameArena::~FrameArena() {
+  if (data_ != nullptr) {
+    munmap(data_, mapped_size_);
+  }
+}
+
+} // namespace cmudb
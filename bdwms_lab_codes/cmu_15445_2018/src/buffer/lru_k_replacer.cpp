@@ -0,0 +1,140 @@
+/**
+ * LRU-K implementation
+ */
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+LRUKReplacer<T>::LRUKReplacer(size_t k, uint64_t correlated_period)
+    : k_(k), correlated_period_(correlated_period) {}
+
+template <typename T> LRUKReplacer<T>::~LRUKReplacer() {}
+
+/*
+ * Record a reference to value and make it evictable
+ */
+template <typename T> void LRUKReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  uint64_t now = ++current_time_;
+  FrameHistory &frame = frames_[value];
+  if (frame.evictable) {
+    evictable_.erase(frame.key);
+  }
+  if (frame.history.empty() || now - frame.last > correlated_period_) {
+    // uncorrelated reference, it goes into the history
+    frame.history.push_back(now);
+    if (frame.history.size() > k_) {
+      frame.history.pop_front();
+    }
+  }
+  frame.last = now;
+  frame.evictable = true;
+  frame.key = std::make_pair(frame.history.size() >= k_ ? 1 : 0,
+                             frame.history.front());
+  evictable_[frame.key] = value;
+}
+
+/*
+ * Evict the frame with the largest backward k-distance and drop its history.
+ * Return false if every frame is pinned
+ */
+template <typename T> bool LRUKReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  auto victim = evictable_.begin();
+  value = victim->second;
+  evictable_.erase(victim);
+  frames_.erase(value);
+  return true;
+}
+
+/*
+ * Evict the frame with the largest backward k-distance among those prefer
+ * accepts, or the plain victim if it accepts none
+ */
+template <typename T>
+bool LRUKReplacer<T>::PreferredVictim(
+    T &value, const std::function<bool(const T &)> &prefer) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  auto victim = evictable_.begin();
+  while (victim != evictable_.end() && !prefer(victim->second)) {
+    ++victim;
+  }
+  if (victim == evictable_.end()) {
+    victim = evictable_.begin();
+  }
+  value = victim->second;
+  evictable_.erase(victim);
+  frames_.erase(value);
+  return true;
+}
+
+/*
+ * Evict the frame with the largest backward k-distance among those accept
+ * accepts, return false if it accepts none
+ */
+template <typename T>
+bool LRUKReplacer<T>::VictimIf(
+    T &value, const std::function<bool(const T &)> &accept) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto victim = evictable_.begin();
+  while (victim != evictable_.end() && !accept(victim->second)) {
+    ++victim;
+  }
+  if (victim == evictable_.end()) {
+    return false;
+  }
+  value = victim->second;
+  evictable_.erase(victim);
+  frames_.erase(value);
+  return true;
+}
+
+/*
+ * The frame got pinned, keep its history but stop considering it for eviction
+ */
+template <typename T> bool LRUKReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = frames_.find(value);
+  if (it == frames_.end() || !it->second.evictable) {
+    return false;
+  }
+  evictable_.erase(it->second.key);
+  it->second.evictable = false;
+  return true;
+}
+
+template <typename T> size_t LRUKReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_.size();
+}
+
+/*
+ * A new page moved into the frame, whatever history it had belongs to the old
+ * page
+ */
+template <typename T>
+void LRUKReplacer<T>::Load(const T &value, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = frames_.find(value);
+  if (it == frames_.end()) {
+    return;
+  }
+  if (it->second.evictable) {
+    evictable_.erase(it->second.key);
+  }
+  frames_.erase(it);
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace cmudb
@@ -76,6 +76,51 @@ bool LRUReplacer<T>::Victim(T &value) {
   return true;
 }
 
+/*
+ * Walk from the least recently used end and pop the first member that prefer
+ * accepts; if there is none, pop the least recently used one as Victim does
+ */
+template<typename T>
+bool LRUReplacer<T>::PreferredVictim(T &value, const std::function<bool(const T &)> &prefer) {
+  lock_guard<mutex> lock(latch);
+  if (map.empty()) {
+    return false;
+  }
+  shared_ptr<Node> cur = tail->prev;
+  while (cur != head && !prefer(cur->val)) {
+    cur = cur->prev;
+  }
+  if (cur == head) {
+    cur = tail->prev;
+  }
+  cur->prev->next = cur->next;
+  cur->next->prev = cur->prev;
+  value = cur->val;
+  map.erase(cur->val);
+  return true;
+}
+
+/*
+ * Walk from the least recently used end and pop the first member that accept
+ * accepts, return false if there is none
+ */
+template<typename T>
+bool LRUReplacer<T>::VictimIf(T &value, const std::function<bool(const T &)> &accept) {
+  lock_guard<mutex> lock(latch);
+  shared_ptr<Node> cur = tail->prev;
+  while (cur != head && !accept(cur->val)) {
+    cur = cur->prev;
+  }
+  if (cur == head) {
+    return false;
+  }
+  cur->prev->next = cur->next;
+  cur->next->prev = cur->prev;
+  value = cur->val;
+  map.erase(cur->val);
+  return true;
+}
+
 /*
  * Remove value from LRU. If removal is successful, return true, otherwise
  * return false
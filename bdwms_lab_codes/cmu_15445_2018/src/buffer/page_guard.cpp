@@ -0,0 +1,60 @@
+/**
+ * page_guard.cpp
+ */
+
+#include "buffer/page_guard.h"
+#include "buffer/buffer_pool_manager.h"
+
+namespace cmudb {
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that)
+    : bpm_(that.bpm_), page_(that.page_) {
+  that.page_ = nullptr;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) {
+  if (this != &that) {
+    Release();
+    bpm_ = that.bpm_;
+    page_ = that.page_;
+    that.page_ = nullptr;
+  }
+  return *this;
+}
+
+void ReadPageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->RUnlatch();
+  bpm_->UnpinFrame(page_, false);
+  page_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&that)
+    : bpm_(that.bpm_), page_(that.page_), is_dirty_(that.is_dirty_) {
+  that.page_ = nullptr;
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) {
+  if (this != &that) {
+    Release();
+    bpm_ = that.bpm_;
+    page_ = that.page_;
+    is_dirty_ = that.is_dirty_;
+    that.page_ = nullptr;
+  }
+  return *this;
+}
+
+void WritePageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->WUnlatch();
+  bpm_->UnpinFrame(page_, is_dirty_);
+  page_ = nullptr;
+  is_dirty_ = true;
+}
+
+} // namespace cmudb
@@ -6,4 +6,10 @@ std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
 //   std::chrono::seconds(1);
 std::chrono::duration<long long int, std::milli> LOG_TIMEOUT =
     std::chrono::milliseconds(100);
+std::chrono::duration<long long int, std::milli> PAGE_CLEANER_TIMEOUT =
+    std::chrono::milliseconds(100);
+std::chrono::duration<long long int, std::milli> WARM_UP_SAVE_TIMEOUT =
+    std::chrono::milliseconds(10000);
+std::chrono::duration<long long int, std::milli> SHRINK_RETRY_TIMEOUT =
+    std::chrono::milliseconds(10);
 }
@@ -0,0 +1,93 @@
+/**
+ * epoch_manager.cpp
+ */
+
+#include <thread>
+
+#include "common/epoch_manager.h"
+
+namespace cmudb {
+
+EpochManager::~EpochManager() {
+  for (auto &retired : retired_) {
+    retired.free();
+  }
+}
+
+/*
+ * A thread starts at its own slot and takes the next free one if another
+ * reader holds it. The slot is published before the caller loads any shared
+ * pointer (both seq_cst), so a writer that scans the slots after unlinking
+ * either sees this reader or is seen by it
+ */
+size_t EpochManager::Enter() {
+  static std::atomic<size_t> next_thread{0};
+  thread_local size_t home = next_thread++ % EPOCH_SLOTS;
+  for (size_t i = home;; i = (i + 1) % EPOCH_SLOTS) {
+    uint64_t expected = 0;
+    uint64_t epoch = global_epoch_.load();
+    if (slots_[i].epoch.compare_exchange_strong(expected, epoch)) {
+      return i;
+    }
+    if ((i + 1) % EPOCH_SLOTS == home) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void EpochManager::Exit(size_t slot) {
+  slots_[slot].epoch.store(0, std::memory_order_release);
+}
+
+/*
+ * the oldest epoch a reader is in, UINT64_MAX if there is none
+ */
+uint64_t EpochManager::MinActiveEpoch() const {
+  uint64_t min_epoch = UINT64_MAX;
+  for (auto &slot : slots_) {
+    uint64_t epoch = slot.epoch.load();
+    if (epoch != 0 && epoch < min_epoch) {
+      min_epoch = epoch;
+    }
+  }
+  return min_epoch;
+}
+
+/*
+ * the caller has unlinked what free releases; a reader that entered after the
+ * epoch advanced cannot reach it
+ */
+void EpochManager::RetireCallback(std::function<void()> free) {
+  uint64_t epoch = global_epoch_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(retired_latch_);
+    retired_.push_back(Retired{epoch, std::move(free)});
+  }
+  Reclaim();
+}
+
+size_t EpochManager::Reclaim() {
+  std::vector<Retired> ready;
+  size_t waiting;
+  {
+    std::lock_guard<std::mutex> lock(retired_latch_);
+    uint64_t min_epoch = MinActiveEpoch();
+    std::vector<Retired> kept;
+    for (auto &retired : retired_) {
+      if (retired.epoch < min_epoch) {
+        ready.push_back(std::move(retired));
+      } else {
+        kept.push_back(std::move(retired));
+      }
+    }
+    retired_.swap(kept);
+    waiting = retired_.size();
+  }
+  // freed outside the latch
+  for (auto &retired : ready) {
+    retired.free();
+  }
+  return waiting;
+}
+
+} // namespace cmudb
@@ -0,0 +1,167 @@
+/**
+ * lz_codec.cpp
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/lz_codec.h"
+
+namespace cmudb {
+
+namespace {
+
+inline uint32_t Load32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline size_t Hash(uint32_t v) {
+  return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+} // namespace
+
+/*
+ * Greedy compression: every position is looked up in a hash table of the
+ * latest position of its first LZ_MIN_MATCH bytes, and a hit is extended as
+ * far as it goes
+ */
+size_t LZCodec::Compress(const char *src, size_t size, char *dst,
+                         size_t capacity) {
+  auto in = reinterpret_cast<const unsigned char *>(src);
+  auto out = reinterpret_cast<unsigned char *>(dst);
+  size_t op = 0;
+  // the rest of a length that did not fit into its nibble
+  auto put_length = [&](size_t len) {
+    for (; len >= 255; len -= 255) {
+      if (op >= capacity) {
+        return false;
+      }
+      out[op++] = 255;
+    }
+    if (op >= capacity) {
+      return false;
+    }
+    out[op++] = static_cast<unsigned char>(len);
+    return true;
+  };
+  // match_len 0: the literals are the end of the input
+  auto put_sequence = [&](size_t literals, size_t literal_len, size_t offset,
+                          size_t match_len) {
+    if (op >= capacity) {
+      return false;
+    }
+    size_t match_code = match_len == 0 ? 0 : match_len - LZ_MIN_MATCH;
+    out[op++] = static_cast<unsigned char>(
+        std::min<size_t>(literal_len, 15) << 4 |
+        std::min<size_t>(match_code, 15));
+    if (literal_len >= 15 && !put_length(literal_len - 15)) {
+      return false;
+    }
+    if (capacity - op < literal_len) {
+      return false;
+    }
+    memcpy(out + op, in + literals, literal_len);
+    op += literal_len;
+    if (match_len == 0) {
+      return true;
+    }
+    if (capacity - op < 2) {
+      return false;
+    }
+    out[op++] = static_cast<unsigned char>(offset & 0xff);
+    out[op++] = static_cast<unsigned char>(offset >> 8);
+    return match_code < 15 || put_length(match_code - 15);
+  };
+
+  uint32_t table[1 << LZ_HASH_BITS] = {}; // position + 1, 0: empty
+  size_t anchor = 0;  // first byte not covered by a sequence yet
+  size_t ip = 0;
+  while (ip + LZ_MIN_MATCH <= size) {
+    uint32_t head = Load32(in + ip);
+    size_t h = Hash(head);
+    size_t candidate = table[h];
+    table[h] = static_cast<uint32_t>(ip + 1);
+    if (candidate == 0 || ip - (candidate - 1) > LZ_MAX_OFFSET ||
+        Load32(in + candidate - 1) != head) {
+      ip++;
+      continue;
+    }
+    size_t match = candidate - 1;
+    size_t len = LZ_MIN_MATCH;
+    while (ip + len < size && in[match + len] == in[ip + len]) {
+      len++;
+    }
+    if (!put_sequence(anchor, ip - anchor, ip - match, len)) {
+      return 0;
+    }
+    ip += len;
+    anchor = ip;
+  }
+  if (!put_sequence(anchor, size - anchor, 0, 0)) {
+    return 0;
+  }
+  return op;
+}
+
+/*
+ * every length and offset is checked against both buffers, so a corrupt
+ * input fails instead of reading or writing out of bounds
+ */
+bool LZCodec::Decompress(const char *src, size_t size, char *dst,
+                         size_t dst_size) {
+  auto in = reinterpret_cast<const unsigned char *>(src);
+  auto out = reinterpret_cast<unsigned char *>(dst);
+  size_t ip = 0;
+  size_t op = 0;
+  auto get_length = [&](size_t &len) {
+    unsigned char b;
+    do {
+      if (ip >= size) {
+        return false;
+      }
+      b = in[ip++];
+      len += b;
+    } while (b == 255);
+    return true;
+  };
+  while (ip < size) {
+    unsigned char token = in[ip++];
+    size_t literal_len = token >> 4;
+    if (literal_len == 15 && !get_length(literal_len)) {
+      return false;
+    }
+    if (size - ip < literal_len || dst_size - op < literal_len) {
+      return false;
+    }
+    memcpy(out + op, in + ip, literal_len);
+    ip += literal_len;
+    op += literal_len;
+    if (ip == size) {
+      break;
+    }
+    if (size - ip < 2) {
+      return false;
+    }
+    size_t offset = in[ip] | static_cast<size_t>(in[ip + 1]) << 8;
+    ip += 2;
+    size_t match_len = token & 15;
+    if (match_len == 15 && !get_length(match_len)) {
+      return false;
+    }
+    match_len += LZ_MIN_MATCH;
+    if (offset == 0 || offset > op || dst_size - op < match_len) {
+      return false;
+    }
+    // byte by byte: the match may overlap the bytes it produces
+    for (size_t i = 0; i < match_len; ++i, ++op) {
+      out[op] = out[op - offset];
+    }
+  }
+  return op == dst_size;
+}
+
+} // namespace cmudb
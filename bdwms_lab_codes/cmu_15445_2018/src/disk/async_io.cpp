@@ -0,0 +1,392 @@
+/**
+ * async_io.cpp
+ */
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define HAVE_IO_URING
+#endif
+
+#include "common/logger.h"
+#include "disk/async_io.h"
+
+namespace cmudb {
+
+/*
+ * pwrite all of size bytes, which the kernel may split into several writes
+ * @return: false on I/O error
+ */
+bool WriteAt(int fd, const char *data, size_t size, size_t offset) {
+  while (size > 0) {
+    ssize_t n = pwrite(fd, data, size, offset);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += n;
+    size -= n;
+    offset += n;
+  }
+  return true;
+}
+
+/*
+ * pread up to size bytes, stopping early only at the end of the file
+ * @return: number of bytes read
+ */
+size_t ReadAt(int fd, char *data, size_t size, size_t offset) {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(fd, data + read_count, size - read_count,
+                      offset + read_count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      break;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += n;
+  }
+  return read_count;
+}
+
+AsyncIO *AsyncIO::Create(int fd, size_t queue_depth, size_t num_threads) {
+  IoUringIO *ring = new IoUringIO(fd, queue_depth);
+  if (ring->Init()) {
+    return ring;
+  }
+  delete ring;
+  LOG_INFO("io_uring unavailable, using %zu I/O threads", num_threads);
+  return new ThreadPoolIO(fd, queue_depth, num_threads);
+}
+
+/*****************************************************************************
+ * IoUringIO
+ *****************************************************************************/
+IoUringIO::IoUringIO(int fd, size_t queue_depth)
+    : fd_(fd), queue_depth_(queue_depth) {}
+
+/*
+ * Submit what is still queued, let the completion thread finish everything in
+ * flight, then tear the ring down
+ */
+IoUringIO::~IoUringIO() {
+#ifdef HAVE_IO_URING
+  if (completion_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(sq_latch_);
+      stop_ = true;
+      // wakes the completion thread if nothing else is in flight; there is an
+      // entry left for it, as every request is submitted at this point
+      unsigned tail = sq_tail_->load(std::memory_order_relaxed);
+      unsigned index = tail & sq_mask_;
+      auto sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;
+      sq_array_[index] = index;
+      sq_tail_->store(tail + 1, std::memory_order_release);
+      unsubmitted_++;
+      Enter(unsubmitted_);
+    }
+    completion_thread_->join();
+    delete completion_thread_;
+  }
+#endif
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+/*
+ * Set the ring up and start the completion thread
+ * @return: false if the kernel has no io_uring or does not let us use it
+ */
+bool IoUringIO::Init() {
+#ifdef HAVE_IO_URING
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = syscall(__NR_io_uring_setup, queue_depth_, &params);
+  if (ring_fd_ < 0) {
+    return false;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+  if (sq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED || cq_ring_ == MAP_FAILED) {
+    sq_ring_ = sq_ring_ == MAP_FAILED ? nullptr : sq_ring_;
+    sqes_ = sqes_ == MAP_FAILED ? nullptr : sqes_;
+    cq_ring_ = cq_ring_ == MAP_FAILED ? nullptr : cq_ring_;
+    return false;
+  }
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<std::atomic<unsigned> *>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<std::atomic<unsigned> *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<std::atomic<unsigned> *>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  // the completion queue (twice as long) can never overflow, and one entry is
+  // kept for the wake-up of the destructor
+  if (queue_depth_ >= params.sq_entries) {
+    queue_depth_ = params.sq_entries - 1;
+  }
+  completion_thread_ = new std::thread([this] { ReapCompletions(); });
+  return true;
+#else
+  return false;
+#endif
+}
+
+void IoUringIO::Read(char *data, size_t size, size_t offset,
+                     Callback callback) {
+  Queue(false, data, size, offset, std::move(callback));
+}
+
+void IoUringIO::Write(const char *data, size_t size, size_t offset,
+                      Callback callback) {
+  Queue(true, const_cast<char *>(data), size, offset, std::move(callback));
+}
+
+/*
+ * Put a request into the submission queue, submitting the queue first if
+ * there are too many requests in flight
+ */
+void IoUringIO::Queue(bool write, char *data, size_t size, size_t offset,
+                      Callback callback) {
+#ifdef HAVE_IO_URING
+  Request *request =
+      new Request{write, iovec{data, size}, std::move(callback)};
+  std::unique_lock<std::mutex> lock(sq_latch_);
+  while (in_flight_ >= queue_depth_) {
+    if (unsubmitted_ > 0) {
+      Enter(unsubmitted_);
+    }
+    room_cv_.wait(lock);
+  }
+  unsigned tail = sq_tail_->load(std::memory_order_relaxed);
+  unsigned index = tail & sq_mask_;
+  auto sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  // plain IORING_OP_READ/WRITE need 5.6, the vectored ones work since 5.1
+  sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd = fd_;
+  sqe->off = offset;
+  sqe->len = 1;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sqe->addr = reinterpret_cast<uint64_t>(&request->iov);
+  sq_array_[index] = index;
+  sq_tail_->store(tail + 1, std::memory_order_release);
+  unsubmitted_++;
+  in_flight_++;
+#else
+  (void)write, (void)data, (void)size, (void)offset, (void)callback;
+#endif
+}
+
+/*
+ * Hand the queued requests to the kernel with one system call
+ */
+void IoUringIO::Submit() {
+  std::lock_guard<std::mutex> lock(sq_latch_);
+  if (unsubmitted_ > 0) {
+    Enter(unsubmitted_);
+  }
+}
+
+void IoUringIO::Enter(unsigned to_submit) {
+#ifdef HAVE_IO_URING
+  while (to_submit > 0) {
+    int submitted =
+        syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0);
+    if (submitted < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // left queued for the next Submit
+      LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+      return;
+    }
+    to_submit -= submitted;
+    unsubmitted_ -= submitted;
+  }
+#else
+  (void)to_submit;
+#endif
+}
+
+void IoUringIO::Complete(Request *request, int result) {
+  bool ok;
+  size_t size = request->iov.iov_len;
+  if (request->write) {
+    ok = result >= 0 && static_cast<size_t>(result) == size;
+  } else {
+    ok = result >= 0;
+    if (ok && static_cast<size_t>(result) < size) {
+      memset(static_cast<char *>(request->iov.iov_base) + result, 0,
+             size - result);
+    }
+  }
+  if (!ok) {
+    LOG_DEBUG("I/O error in io_uring request: %d", result);
+  }
+  request->callback(ok);
+  delete request;
+  std::lock_guard<std::mutex> lock(sq_latch_);
+  in_flight_--;
+  room_cv_.notify_one();
+}
+
+/*
+ * Completion thread: wait for completions and run their callbacks, until the
+ * destructor has asked it to stop and nothing is in flight any more
+ */
+void IoUringIO::ReapCompletions() {
+#ifdef HAVE_IO_URING
+  while (true) {
+    unsigned head = cq_head_->load(std::memory_order_relaxed);
+    unsigned tail = cq_tail_->load(std::memory_order_acquire);
+    while (head != tail) {
+      io_uring_cqe cqe = static_cast<io_uring_cqe *>(cqes_)[head & cq_mask_];
+      // hand the entry back before the callback, which may take a while
+      cq_head_->store(++head, std::memory_order_release);
+      if (cqe.user_data != 0) {
+        Complete(reinterpret_cast<Request *>(cqe.user_data), cqe.res);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(sq_latch_);
+      if (stop_ && in_flight_ == 0) {
+        return;
+      }
+    }
+    int rc = syscall(__NR_io_uring_enter, ring_fd_, 0, 1,
+                     IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (rc < 0 && errno != EINTR) {
+      LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+    }
+  }
+#endif
+}
+
+/*****************************************************************************
+ * ThreadPoolIO
+ *****************************************************************************/
+ThreadPoolIO::ThreadPoolIO(int fd, size_t queue_depth, size_t num_threads)
+    : fd_(fd), queue_depth_(queue_depth) {
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this] { Run(); });
+  }
+}
+
+/*
+ * Submit what is still queued and let the threads finish it
+ */
+ThreadPoolIO::~ThreadPoolIO() {
+  Submit();
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPoolIO::Read(char *data, size_t size, size_t offset,
+                        Callback callback) {
+  Queue(Request{false, data, size, offset, std::move(callback)});
+}
+
+void ThreadPoolIO::Write(const char *data, size_t size, size_t offset,
+                         Callback callback) {
+  Queue(Request{true, const_cast<char *>(data), size, offset,
+                std::move(callback)});
+}
+
+void ThreadPoolIO::Queue(Request request) {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (in_flight_ >= queue_depth_) {
+    if (!unsubmitted_.empty()) {
+      submitted_.insert(submitted_.end(), unsubmitted_.begin(),
+                        unsubmitted_.end());
+      unsubmitted_.clear();
+      work_cv_.notify_all();
+    }
+    room_cv_.wait(lock);
+  }
+  unsubmitted_.push_back(std::move(request));
+  in_flight_++;
+}
+
+void ThreadPoolIO::Submit() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (unsubmitted_.empty()) {
+      return;
+    }
+    submitted_.insert(submitted_.end(), unsubmitted_.begin(),
+                      unsubmitted_.end());
+    unsubmitted_.clear();
+  }
+  work_cv_.notify_all();
+}
+
+/*
+ * I/O thread: run submitted requests until stopped and none are left
+ */
+void ThreadPoolIO::Run() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    work_cv_.wait(lock, [this] { return stop_ || !submitted_.empty(); });
+    if (submitted_.empty()) {
+      return;
+    }
+    Request request = std::move(submitted_.front());
+    submitted_.pop_front();
+    lock.unlock();
+    bool ok;
+    if (request.write) {
+      ok = WriteAt(fd_, request.data, request.size, request.offset);
+    } else {
+      size_t read_count =
+          ReadAt(fd_, request.data, request.size, request.offset);
+      memset(request.data + read_count, 0, request.size - read_count);
+      ok = true;
+    }
+    request.callback(ok);
+    lock.lock();
+    in_flight_--;
+    room_cv_.notify_one();
+  }
+}
+
+} // namespace cmudb
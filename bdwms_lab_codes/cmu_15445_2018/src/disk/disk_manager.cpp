@@ -3,24 +3,32 @@
  */
 #include <assert.h>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <memory>
 #include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
 
 #include "common/logger.h"
+#include "disk/async_io.h"
 #include "disk/disk_manager.h"
 
 namespace cmudb {
 
-
+// first bytes of the file header, followed by the page size (uint32_t)
+static const char DB_FILE_MAGIC[8] = "CMUDB01";
 
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of a new database file, a power of two
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-      flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, size_t page_size)
+    : db_fd_(-1), unsynced_(false), num_syncs_(0), file_name_(db_file),
+      page_size_(page_size), next_page_id_(0), num_flushes_(0), flush_log_(false), flush_log_f_(nullptr) {
+  assert(page_size_ >= sizeof(DB_FILE_MAGIC) + sizeof(uint32_t) &&
+         (page_size_ & (page_size_ - 1)) == 0);
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -42,61 +50,143 @@ DiskManager::DiskManager(const std::string &db_file)
                                 std::ios::out);
   }
 
-  db_io_.open(db_file,
-              std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // create the file if it does not exist
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    LOG_DEBUG("can't open db file");
+    return;
+  }
+  if (GetFileSize(file_name_) > 0) {
+    ReadFileHeader();
+  } else {
+    WriteFileHeader();
   }
 }
 
 DiskManager::~DiskManager() {
-  db_io_.close();
+  // lets the I/Os in flight complete
+  delete async_io_;
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
   log_io_.close();
 }
 
 /**
- * Write the contents of the specified page into disk file
+ * Write the contents of the specified page into disk file. Like WritePages it
+ * does not sync, see Sync
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  WritePages(page_id, page_data, 1);
+}
+
+/**
+ * Write num_pages consecutive pages, starting at first_page_id, from one
+ * contiguous buffer with a single write
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *data,
+                             size_t num_pages) {
+  size_t offset = (static_cast<size_t>(first_page_id) + 1) * page_size_;
+  if (!WriteAt(db_fd_, data, num_pages * page_size_, offset)) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  unsynced_.store(true);
+}
+
+/**
+ * Make every page written so far durable. Writers call it once after a batch
+ * of writes; a call with nothing written since the previous one is free
+ */
+void DiskManager::Sync() {
+  // a write that lands after the exchange sets the flag again for the next call
+  if (!unsynced_.exchange(false)) {
+    return;
+  }
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+    unsynced_.store(true);
+    return;
+  }
+  num_syncs_++;
+}
+
+/**
+ * Private helper function to set the asynchronous I/O backend up on first use
+ */
+AsyncIO *DiskManager::GetAsyncIO() {
+  std::call_once(async_io_once_, [this] {
+    async_io_ = AsyncIO::Create(db_fd_, ASYNC_IO_QUEUE_DEPTH, ASYNC_IO_THREADS);
+  });
+  return async_io_;
+}
+
+/**
+ * Queue a read of the specified page into the given memory area, which has
+ * to stay valid until the callback has run. Short reads are handled as in
+ * ReadPage
+ */
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data,
+                                std::function<void(bool)> callback) {
+  size_t offset = (static_cast<size_t>(page_id) + 1) * page_size_;
+  GetAsyncIO()->Read(page_data, page_size_, offset, std::move(callback));
+}
+
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id,
+                                             char *page_data) {
+  auto done = std::make_shared<std::promise<bool>>();
+  ReadPageAsync(page_id, page_data, [done](bool ok) { done->set_value(ok); });
+  return done->get_future();
+}
+
+/**
+ * Queue a write of the specified page from the given memory area, which has
+ * to stay valid (and unchanged) until the callback has run
+ */
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data,
+                                 std::function<void(bool)> callback) {
+  size_t offset = (static_cast<size_t>(page_id) + 1) * page_size_;
+  GetAsyncIO()->Write(page_data, page_size_, offset,
+                      [this, callback](bool ok) {
+                        if (ok) {
+                          unsynced_.store(true);
+                        }
+                        callback(ok);
+                      });
+}
+
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id,
+                                              const char *page_data) {
+  auto done = std::make_shared<std::promise<bool>>();
+  WritePageAsync(page_id, page_data, [done](bool ok) { done->set_value(ok); });
+  return done->get_future();
 }
 
+/**
+ * Hand every asynchronous I/O queued so far to the kernel at once
+ */
+void DiskManager::SubmitAsync() { GetAsyncIO()->Submit(); }
+
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+  ReadPages(page_id, page_data, 1);
+}
+
+/**
+ * Read num_pages consecutive pages, starting at first_page_id, into one
+ * contiguous buffer with a single read. The part beyond the end of the file
+ * is zeroed
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, char *data,
+                            size_t num_pages) {
+  size_t offset = (static_cast<size_t>(first_page_id) + 1) * page_size_;
+  size_t size = num_pages * page_size_;
+  size_t read_count = ReadAt(db_fd_, data, size, offset);
+  if (read_count < size) {
+    LOG_DEBUG("Read less than a page");
+    memset(data + read_count, 0, size - read_count);
   }
 }
 
@@ -170,16 +260,65 @@ void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
   return;
 }
 
+/**
+ * Returns number of pages in the db file, not counting the file header
+ */
+size_t DiskManager::GetNumPages() const {
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0 ||
+      static_cast<size_t>(stat_buf.st_size) < page_size_) {
+    return 0;
+  }
+  return stat_buf.st_size / page_size_ - 1;
+}
+
 /**
  * Returns number of flushes made so far
  */
 int DiskManager::GetNumFlushes() const { return num_flushes_; }
 
+/**
+ * Returns number of fdatasyncs of the db file made so far
+ */
+int DiskManager::GetNumSyncs() const { return num_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Private helper function to take the page size over from the header of an
+ * existing database file
+ */
+void DiskManager::ReadFileHeader() {
+  char header[sizeof(DB_FILE_MAGIC) + sizeof(uint32_t)];
+  if (ReadAt(db_fd_, header, sizeof(header), 0) < sizeof(header) ||
+      memcmp(header, DB_FILE_MAGIC, sizeof(DB_FILE_MAGIC)) != 0) {
+    LOG_DEBUG("wrong db file format");
+    return;
+  }
+  uint32_t page_size;
+  memcpy(&page_size, header + sizeof(DB_FILE_MAGIC), sizeof(uint32_t));
+  page_size_ = page_size;
+}
+
+/**
+ * Private helper function to record the page size at the start of a new
+ * database file
+ */
+void DiskManager::WriteFileHeader() {
+  char *header = new char[page_size_]();
+  uint32_t page_size = page_size_;
+  memcpy(header, DB_FILE_MAGIC, sizeof(DB_FILE_MAGIC));
+  memcpy(header + sizeof(DB_FILE_MAGIC), &page_size, sizeof(uint32_t));
+  if (!WriteAt(db_fd_, header, page_size_, 0)) {
+    LOG_DEBUG("I/O error while writing");
+  }
+  unsynced_.store(true);
+  delete[] header;
+}
+
 /**
  * Private helper function to get disk file size
  */
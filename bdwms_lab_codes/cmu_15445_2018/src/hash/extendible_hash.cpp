@@ -1,4 +1,12 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <list>
+#include <thread>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "hash/extendible_hash.h"
 #include "page/page.h"
@@ -7,18 +15,65 @@ using namespace std;
 
 namespace cmudb {
 
+namespace {
+
+/*
+ * bit i set if group[i] == byte, for the FINGERPRINT_GROUP bytes at group
+ */
+inline uint32_t MatchByte(const uint8_t *group, uint8_t byte) {
+#if defined(__AVX2__)
+  __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(group));
+  __m256i pattern = _mm256_set1_epi8(static_cast<char>(byte));
+  return static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, pattern)));
+#elif defined(__SSE2__)
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  __m128i pattern = _mm_set1_epi8(static_cast<char>(byte));
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, pattern)));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < FINGERPRINT_GROUP; ++i) {
+    mask |= static_cast<uint32_t>(group[i] == byte) << i;
+  }
+  return mask;
+#endif
+}
+
+} // namespace
+
+template<typename K, typename V>
+ExtendibleHash<K, V>::Bucket::Bucket(int depth, size_t capacity)
+    : localDepth(depth), size(0), version(0),
+      fingerprints((capacity + FINGERPRINT_GROUP - 1) / FINGERPRINT_GROUP *
+                   FINGERPRINT_GROUP, 0),
+      keys(capacity), values(capacity) {}
+
+template<typename K, typename V>
+ExtendibleHash<K, V>::Directory::Directory(int depth)
+    : globalDepth(depth), entries(static_cast<size_t>(1) << depth) {}
+
 /*
  * constructor
  * array_size: fixed array size for each bucket
  */
 template<typename K, typename V>
-ExtendibleHash<K, V>::ExtendibleHash(size_t size):globalDepth(0), bucketSize(size), bucketNum(1) {
-  directories.push_back(make_shared<Bucket>(0));
+ExtendibleHash<K, V>::ExtendibleHash(size_t size)
+    : bucketSize(size), bucketNum(1),
+      bucketsAtDepth(numeric_limits<size_t>::digits + 1, 0) {
+  buckets.emplace_back(new Bucket(0, bucketSize));
+  bucketsAtDepth[0] = 1;
+  Directory *dir = new Directory(0);
+  dir->entries[0].store(buckets[0].get());
+  directory.store(dir);
 }
 
 template<typename K, typename V>
-ExtendibleHash<K, V>::ExtendibleHash() {
-  ExtendibleHash(64);
+ExtendibleHash<K, V>::ExtendibleHash() : ExtendibleHash(64) {}
+
+template<typename K, typename V>
+ExtendibleHash<K, V>::~ExtendibleHash() {
+  delete directory.load();
 }
 
 /*
@@ -29,6 +84,16 @@ size_t ExtendibleHash<K, V>::HashKey(const K &key) const {
   return hash<K>{}(key);
 }
 
+/*
+ * the fingerprint comes from the top bits of the mixed hash: the directory
+ * uses the low bits, and std::hash of an integer is the integer itself
+ */
+template<typename K, typename V>
+uint8_t ExtendibleHash<K, V>::Fingerprint(size_t hash) {
+  uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<uint8_t>(0x80 | (mixed >> 57));
+}
+
 /*
  * helper function to return global depth of hash table
  * NOTE: you must implement this function in order to pass test
@@ -36,7 +101,7 @@ size_t ExtendibleHash<K, V>::HashKey(const K &key) const {
 template<typename K, typename V>
 int ExtendibleHash<K, V>::GetGlobalDepth() const {
   lock_guard<mutex> lock(latch);
-  return globalDepth;
+  return directory.load()->globalDepth;
 }
 
 /*
@@ -45,14 +110,18 @@ int ExtendibleHash<K, V>::GetGlobalDepth() const {
  */
 template<typename K, typename V>
 int ExtendibleHash<K, V>::GetLocalDepth(int bucket_id) const {
-  if (directories[bucket_id]) {
-    lock_guard<mutex> lck(directories[bucket_id]->latch);
-    if (directories[bucket_id]->kmap.size() == 0) {
-      return -1;
-    }
-    return directories[bucket_id]->localDepth;
+  // a merge frees the bucket only after this guard is gone
+  EpochGuard guard(epochs);
+  Bucket *cur;
+  {
+    lock_guard<mutex> lock(latch);
+    cur = directory.load()->entries[bucket_id].load();
   }
-  return -1;
+  lock_guard<mutex> lck(cur->latch);
+  if (cur->size == 0) {
+    return -1;
+  }
+  return cur->localDepth;
 }
 
 /*
@@ -64,18 +133,255 @@ int ExtendibleHash<K, V>::GetNumBuckets() const {
   return bucketNum;
 }
 
+template<typename K, typename V>
+size_t ExtendibleHash<K, V>::GetMemoryUsage() const {
+  lock_guard<mutex> lock(latch);
+  size_t bucket_bytes =
+      sizeof(Bucket) + buckets[0]->fingerprints.size() +
+      bucketSize * (sizeof(K) + sizeof(V));
+  return sizeof(Directory) +
+         directory.load()->entries.size() * sizeof(atomic<Bucket *>) +
+         bucketNum * bucket_bytes;
+}
+
+/*
+ * slots whose fingerprint matches are found a group at a time, only their
+ * keys are compared
+ */
+template<typename K, typename V>
+int ExtendibleHash<K, V>::FindSlot(const Bucket &bucket, uint8_t fingerprint,
+                                   const K &key) {
+  for (size_t base = 0; base < bucket.fingerprints.size();
+       base += FINGERPRINT_GROUP) {
+    uint32_t matches = MatchByte(&bucket.fingerprints[base], fingerprint);
+    while (matches != 0) {
+      size_t slot = base + __builtin_ctz(matches);
+      if (bucket.keys[slot] == key) {
+        return static_cast<int>(slot);
+      }
+      matches &= matches - 1;
+    }
+  }
+  return -1;
+}
+
+template<typename K, typename V>
+int ExtendibleHash<K, V>::FindEmptySlot(const Bucket &bucket) const {
+  if (bucket.size >= bucketSize) {
+    return -1;
+  }
+  for (size_t base = 0; base < bucket.fingerprints.size();
+       base += FINGERPRINT_GROUP) {
+    uint32_t empty = MatchByte(&bucket.fingerprints[base], 0);
+    if (empty != 0) {
+      return static_cast<int>(base + __builtin_ctz(empty));
+    }
+  }
+  return -1;
+}
+
 /*
  * lookup function to find value associate with input key
+ * the slots of trivially copyable keys and values can be read while a writer
+ * changes them, the version check throws such a read away
  */
 template<typename K, typename V>
 bool ExtendibleHash<K, V>::Find(const K &key, V &value) {
-  int idx = getIdx(key);
-  lock_guard<mutex> lck(directories[idx]->latch);
-  if (directories[idx]->kmap.find(key) != directories[idx]->kmap.end()) {
-    value = directories[idx]->kmap[key];
+  const size_t hash = HashKey(key);
+  const uint8_t fingerprint = Fingerprint(hash);
+  if (!(is_trivially_copyable<K>::value && is_trivially_copyable<V>::value)) {
+    unique_lock<mutex> lck;
+    Bucket *cur = LatchBucket(key, lck);
+    int slot = FindSlot(*cur, fingerprint, key);
+    if (slot < 0) {
+      return false;
+    }
+    value = cur->values[slot];
     return true;
   }
-  return false;
+
+  EpochGuard guard(epochs);
+  while (true) {
+    Directory *dir = directory.load(memory_order_acquire);
+    Bucket *cur = dir->entries[hash & ((1 << dir->globalDepth) - 1)].load(
+        memory_order_acquire);
+    uint64_t before = cur->version.load(memory_order_acquire);
+    if (before & 1) {
+      this_thread::yield();
+      continue;
+    }
+    int slot = FindSlot(*cur, fingerprint, key);
+    V found = slot < 0 ? V() : cur->values[slot];
+    atomic_thread_fence(memory_order_acquire);
+    if (cur->version.load(memory_order_relaxed) != before) {
+      continue;
+    }
+    // a split that finished before the first version read moved the key
+    // elsewhere; it published the directory before the version, so it shows
+    dir = directory.load(memory_order_acquire);
+    if (dir->entries[hash & ((1 << dir->globalDepth) - 1)].load(
+            memory_order_acquire) != cur) {
+      continue;
+    }
+    if (slot < 0) {
+      return false;
+    }
+    value = found;
+    return true;
+  }
+}
+
+/*
+ * software pipeline over the keys of a batch, in the order they are probed:
+ * the Bucket of the key PREFETCH_BUCKET ahead, the fingerprints of the one
+ * PREFETCH_FINGERPRINTS ahead (its Bucket is in cache by then) and the key
+ * and value slots whose fingerprint matches for the one PREFETCH_SLOTS ahead
+ */
+template<typename K, typename V>
+void ExtendibleHash<K, V>::PrefetchAhead(const vector<BatchKey> &batch,
+                                         size_t k) {
+  const size_t PREFETCH_BUCKET = 8;
+  const size_t PREFETCH_FINGERPRINTS = 4;
+  const size_t PREFETCH_SLOTS = 2;
+  if (k + PREFETCH_BUCKET < batch.size()) {
+    __builtin_prefetch(batch[k + PREFETCH_BUCKET].bucket);
+  }
+  if (k + PREFETCH_FINGERPRINTS < batch.size()) {
+    const Bucket *bucket = batch[k + PREFETCH_FINGERPRINTS].bucket;
+    for (size_t base = 0; base < bucket->fingerprints.size(); base += 64) {
+      __builtin_prefetch(&bucket->fingerprints[base]);
+    }
+  }
+  if (k + PREFETCH_SLOTS < batch.size()) {
+    const Bucket *bucket = batch[k + PREFETCH_SLOTS].bucket;
+    const uint8_t fingerprint = Fingerprint(batch[k + PREFETCH_SLOTS].hash);
+    for (size_t base = 0; base < bucket->fingerprints.size();
+         base += FINGERPRINT_GROUP) {
+      uint32_t matches = MatchByte(&bucket->fingerprints[base], fingerprint);
+      while (matches != 0) {
+        size_t slot = base + __builtin_ctz(matches);
+        __builtin_prefetch(&bucket->keys[slot]);
+        __builtin_prefetch(&bucket->values[slot]);
+        matches &= matches - 1;
+      }
+    }
+  }
+}
+
+/*
+ * Sorting by bucket only pays when keys are likely to share buckets, i.e.
+ * when there are more keys than directory slots; otherwise the keys keep
+ * their order and only neighbours in the same bucket form a group
+ */
+template<typename K, typename V>
+void ExtendibleHash<K, V>::GroupByBucket(const vector<K> &keys,
+                                         vector<BatchKey> &batch) {
+  Directory *dir = directory.load(memory_order_acquire);
+  const size_t mask = dir->entries.size() - 1;
+  batch.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    batch[i].hash = HashKey(keys[i]);
+    batch[i].bucket =
+        dir->entries[batch[i].hash & mask].load(memory_order_acquire);
+    batch[i].index = i;
+  }
+  if (keys.size() > dir->entries.size()) {
+    // the index breaks ties: the keys of a bucket keep the order they were
+    // given in
+    sort(batch.begin(), batch.end(),
+         [](const BatchKey &a, const BatchKey &b) {
+           return a.bucket != b.bucket ? less<Bucket *>()(a.bucket, b.bucket)
+                                       : a.index < b.index;
+         });
+  }
+}
+
+/*
+ * end of the group of keys that starts at begin
+ */
+template<typename K, typename V>
+size_t ExtendibleHash<K, V>::GroupEnd(const vector<BatchKey> &batch,
+                                      size_t begin) {
+  size_t end = begin + 1;
+  while (end < batch.size() && batch[end].bucket == batch[begin].bucket) {
+    end++;
+  }
+  return end;
+}
+
+/*
+ * batched Find: each bucket's keys are probed together, inside one version
+ * window (or under one latch for keys and values that are not trivially
+ * copyable). A group that a writer got in the way of is looked up again key
+ * by key
+ */
+template<typename K, typename V>
+size_t ExtendibleHash<K, V>::FindBatch(const vector<K> &keys,
+                                       vector<V> &values,
+                                       vector<bool> &found) {
+  if (keys.size() == 1) {
+    // nothing to share: skip the grouping
+    return HashTable<K, V>::FindBatch(keys, values, found);
+  }
+  values.assign(keys.size(), V());
+  found.assign(keys.size(), false);
+  const bool optimistic =
+      is_trivially_copyable<K>::value && is_trivially_copyable<V>::value;
+  size_t hits = 0;
+  vector<size_t> retry;
+  {
+    EpochGuard guard(epochs);
+    vector<BatchKey> batch;
+    GroupByBucket(keys, batch);
+    for (size_t begin = 0, end; begin < batch.size(); begin = end) {
+      end = GroupEnd(batch, begin);
+      Bucket *cur = batch[begin].bucket;
+      unique_lock<mutex> lck;
+      uint64_t before = 0;
+      if (optimistic) {
+        before = cur->version.load(memory_order_acquire);
+      } else {
+        cur = LatchBucket(keys[batch[begin].index], lck);
+      }
+      bool valid = !(before & 1);
+      size_t group_hits = 0;
+      for (size_t k = begin; valid && k < end; k++) {
+        PrefetchAhead(batch, k);
+        size_t i = batch[k].index;
+        int slot = FindSlot(*cur, Fingerprint(batch[k].hash), keys[i]);
+        if (slot >= 0) {
+          values[i] = cur->values[slot];
+          found[i] = true;
+          group_hits++;
+        }
+      }
+      if (optimistic && valid) {
+        atomic_thread_fence(memory_order_acquire);
+        valid = cur->version.load(memory_order_relaxed) == before;
+      }
+      // a split may have moved keys elsewhere since they were grouped
+      Directory *dir = directory.load(memory_order_acquire);
+      const size_t mask = dir->entries.size() - 1;
+      for (size_t k = begin; valid && k < end; k++) {
+        valid = dir->entries[batch[k].hash & mask].load(
+                    memory_order_acquire) == cur;
+      }
+      if (valid) {
+        hits += group_hits;
+      } else {
+        for (size_t k = begin; k < end; k++) {
+          retry.push_back(batch[k].index);
+        }
+      }
+    }
+  }
+  for (size_t i : retry) {
+    V value;
+    found[i] = Find(keys[i], value);
+    values[i] = found[i] ? value : V();
+    hits += found[i];
+  }
+  return hits;
 }
 
 /*
@@ -84,25 +390,162 @@ bool ExtendibleHash<K, V>::Find(const K &key, V &value) {
 template<typename K, typename V>
 int ExtendibleHash<K, V>::getIdx(const K &key) const {
   lock_guard<mutex> lock(latch);
-  return HashKey(key) & ((1 << globalDepth) - 1);  // return globalDepth length LSBs of HashKey(key)
+  return HashKey(key) & ((1 << directory.load()->globalDepth) - 1);  // return globalDepth length LSBs of HashKey(key)
+}
+
+/*
+ * look the bucket up and latch it; a split between the two moves the key
+ * elsewhere, so the directory is checked again under the bucket latch
+ */
+template<typename K, typename V>
+typename ExtendibleHash<K, V>::Bucket *
+ExtendibleHash<K, V>::LatchBucket(const K &key,
+                                  unique_lock<mutex> &bucket_lock) {
+  const size_t hash = HashKey(key);
+  EpochGuard guard(epochs);
+  while (true) {
+    Directory *dir = directory.load();
+    Bucket *cur = dir->entries[hash & ((1 << dir->globalDepth) - 1)].load();
+    unique_lock<mutex> lck(cur->latch);
+    // entries only move away from a bucket while its latch is held
+    dir = directory.load();
+    if (dir->entries[hash & ((1 << dir->globalDepth) - 1)].load() == cur) {
+      bucket_lock = std::move(lck);
+      return cur;
+    }
+  }
+}
+
+/*
+ * the version is odd from BeginWrite to EndWrite, a reader that saw either
+ * retries
+ */
+template<typename K, typename V>
+void ExtendibleHash<K, V>::BeginWrite(Bucket &bucket) {
+  bucket.version.store(bucket.version.load(memory_order_relaxed) + 1,
+                       memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+template<typename K, typename V>
+void ExtendibleHash<K, V>::EndWrite(Bucket &bucket) {
+  bucket.version.store(bucket.version.load(memory_order_relaxed) + 1,
+                       memory_order_release);
 }
 
 /*
  * delete <key,value> entry in hash table
- * Shrink & Combination is not required for this project
+ * a bucket that is at most half full may merge with its buddy
  */
 template<typename K, typename V>
 bool ExtendibleHash<K, V>::Remove(const K &key) {
-  int idx = getIdx(key);
-  lock_guard<mutex> lck(directories[idx]->latch);
-  shared_ptr<Bucket> cur = directories[idx];  // use smart pointer to simplify memory management
-  if (cur->kmap.find(key) == cur->kmap.end()) {
+  const size_t hash = HashKey(key);
+  unique_lock<mutex> lck;
+  Bucket *cur = LatchBucket(key, lck);
+  int slot = FindSlot(*cur, Fingerprint(hash), key);
+  if (slot < 0) {
     return false;
   }
-  cur->kmap.erase(key);
+  BeginWrite(*cur);
+  cur->fingerprints[slot] = 0;
+  cur->keys[slot] = K();
+  cur->values[slot] = V();
+  cur->size--;
+  EndWrite(*cur);
+  if (cur->localDepth > 0 && cur->size <= bucketSize / 2) {
+    Merge(hash, cur, lck);
+  }
   return true;
 }
 
+/*
+ * The bucket whose entries have the top local depth bit set moves its slots
+ * into the other one and hands it its entries. Its version stays odd, so
+ * lock-free readers that still have it go back to the directory. The buddy
+ * latch is only tried: the order is bucket, then directory latch, and a
+ * thread that holds the buddy may be waiting for the directory
+ */
+template<typename K, typename V>
+void ExtendibleHash<K, V>::Merge(size_t hash, Bucket *cur,
+                                 unique_lock<mutex> &bucket_lock) {
+  lock_guard<mutex> lock(latch);
+  while (cur->localDepth > 0 && cur->size <= bucketSize / 2) {
+    Directory *dir = directory.load(memory_order_relaxed);
+    const size_t half = static_cast<size_t>(1) << (cur->localDepth - 1);
+    const size_t index = hash & (2 * half - 1);
+    Bucket *buddy = dir->entries[index ^ half].load(memory_order_relaxed);
+    unique_lock<mutex> buddy_lock(buddy->latch, try_to_lock);
+    if (!buddy_lock.owns_lock() || buddy->localDepth != cur->localDepth ||
+        cur->size + buddy->size > bucketSize / 2) {
+      break;
+    }
+    Bucket *low = (index & half) ? buddy : cur;
+    Bucket *high = low == cur ? buddy : cur;
+    BeginWrite(*low);
+    BeginWrite(*high);
+    for (size_t i = 0; i < bucketSize; i++) {
+      if (high->fingerprints[i] != 0) {
+        int empty = FindEmptySlot(*low);
+        low->fingerprints[empty] = high->fingerprints[i];
+        low->keys[empty] = std::move(high->keys[i]);
+        low->values[empty] = std::move(high->values[i]);
+        low->size++;
+      }
+    }
+    bucketsAtDepth[low->localDepth] -= 2;
+    low->localDepth--;
+    bucketsAtDepth[low->localDepth]++;
+    for (size_t i = (index & (half - 1)) | half; i < dir->entries.size();
+         i += 2 * half) {
+      dir->entries[i].store(low, memory_order_release);
+    }
+    EndWrite(*low);
+
+    // keep low latched, a thread waiting for high looks the key up again
+    if (low == buddy) {
+      bucket_lock = std::move(buddy_lock);
+    } else {
+      buddy_lock.unlock();
+    }
+    for (auto &bucket : buckets) {
+      if (bucket.get() == high) {
+        bucket.release();
+        bucket = std::move(buckets.back());
+        buckets.pop_back();
+        break;
+      }
+    }
+    bucketNum--;
+    epochs.Retire(high);
+    cur = low;
+  }
+  ShrinkDirectory();
+}
+
+/*
+ * under latch: halve the directory down to one level deeper than its deepest
+ * bucket, once it is two levels deeper. The first half of the entries is the
+ * whole table then, readers keep using the old directory until it is retired
+ */
+template<typename K, typename V>
+void ExtendibleHash<K, V>::ShrinkDirectory() {
+  Directory *dir = directory.load(memory_order_relaxed);
+  int deepest = dir->globalDepth;
+  while (deepest > 0 && bucketsAtDepth[deepest] == 0) {
+    deepest--;
+  }
+  if (deepest + 2 > dir->globalDepth) {
+    return;
+  }
+  Directory *target = new Directory(deepest + 1);
+  for (size_t i = 0; i < target->entries.size(); i++) {
+    target->entries[i].store(dir->entries[i].load(memory_order_relaxed),
+                             memory_order_relaxed);
+  }
+  directory.store(target);
+  epochs.Retire(dir);
+}
+
 /*
  * insert <key,value> entry in hash table
  * Split & Redistribute bucket when there is overflow and if necessary increase
@@ -110,51 +553,137 @@ bool ExtendibleHash<K, V>::Remove(const K &key) {
  */
 template<typename K, typename V>
 void ExtendibleHash<K, V>::Insert(const K &key, const V &value) {
-  int idx = getIdx(key);
-  shared_ptr<Bucket> cur = directories[idx];  // get the specific bucket according to the key
+  const uint8_t fingerprint = Fingerprint(HashKey(key));
   while (true) {  // maybe it isn't enough to complete the insert the data in only one round
-    lock_guard<mutex> lck(cur->latch);
-    if (cur->kmap.find(key) != cur->kmap.end() || cur->kmap.size() < bucketSize) {
-      cur->kmap[key] = value;
-      break;
+    unique_lock<mutex> lck;
+    Bucket *cur = LatchBucket(key, lck);  // get the specific bucket according to the key
+    int slot = FindSlot(*cur, fingerprint, key);
+    if (slot >= 0) {
+      BeginWrite(*cur);
+      cur->values[slot] = value;
+      EndWrite(*cur);
+      return;
+    }
+    slot = FindEmptySlot(*cur);
+    if (slot >= 0) {
+      BeginWrite(*cur);
+      cur->fingerprints[slot] = fingerprint;
+      cur->keys[slot] = key;
+      cur->values[slot] = value;
+      cur->size++;
+      EndWrite(*cur);
+      return;
     }
     // from here, deal with the problem about the spliting
     int mask = (1
         << (cur->localDepth));  // mask means higher one bit to judge the entry is in old or new bucket.
+    Bucket *newBuc = new Bucket(cur->localDepth + 1, bucketSize);  // create a new bucket with the new localDepth
+
+    BeginWrite(*cur);
     cur->localDepth++;
 
-    {  // pay attention to this scope, it should be locked when different threads modify the directory
-      lock_guard<mutex> lock(latch);  // lock the dictionary
-      if (cur->localDepth > globalDepth) {
-        size_t length = directories.size();
-        for (size_t i = 0; i < length; i++) {
-          directories.push_back(directories[i]);
-        }
-        globalDepth++;
+    for (size_t i = 0; i < bucketSize; i++) {  // rehash each entry with a new local depth
+      if (cur->fingerprints[i] != 0 && (HashKey(cur->keys[i]) & mask)) {
+        // if the higher bit is 1, move this entry to the new bucket
+        size_t moved = newBuc->size++;
+        newBuc->fingerprints[moved] = cur->fingerprints[i];
+        newBuc->keys[moved] = std::move(cur->keys[i]);
+        newBuc->values[moved] = std::move(cur->values[i]);
+        cur->fingerprints[i] = 0;
+        cur->keys[i] = K();
+        cur->values[i] = V();
+        cur->size--;
       }
-      bucketNum++;
-      auto newBuc = make_shared<Bucket>(cur->localDepth);  // create a new bucket with the new localDepth
-
-      typename map<K, V>::iterator iter;
-      for (iter = cur->kmap.begin(); iter != cur->kmap.end();) {  // rehash each entry with a new local depth
-        if (HashKey(iter->first) &
-            mask) {  // if the higher bit is 1, allocate this entry to new bucket, and delete it from old bucket
-          newBuc->kmap[iter->first] = iter->second;
-          iter = cur->kmap.erase(iter);  // erase return the next iter
-        } else {  // else keep it in old bucket
-          iter++;
-        }
+    }
+
+    // pay attention to this scope, it should be locked when different threads modify the directory
+    // (only the latch of cur is needed until here)
+    lock_guard<mutex> lock(latch);  // lock the dictionary
+    buckets.emplace_back(newBuc);
+    bucketNum++;
+    bucketsAtDepth[cur->localDepth - 1]--;
+    bucketsAtDepth[cur->localDepth] += 2;
+    // readers keep using the old directory until the bigger one is published
+    Directory *dir = directory.load(memory_order_relaxed);
+    Directory *target = dir;
+    if (cur->localDepth > dir->globalDepth) {
+      target = new Directory(dir->globalDepth + 1);
+      size_t length = dir->entries.size();
+      for (size_t i = 0; i < length; i++) {
+        Bucket *entry = dir->entries[i].load(memory_order_relaxed);
+        target->entries[i].store(entry, memory_order_relaxed);
+        target->entries[i + length].store(entry, memory_order_relaxed);
       }
+    }
+    // the entries of cur are the ones that agree with key in the low bits
+    // below mask; those with the mask bit set go to the new bucket
+    for (size_t i = (HashKey(key) & (mask - 1)) | mask;
+         i < target->entries.size(); i += 2 * mask) {
+      target->entries[i].store(newBuc, memory_order_release);
+    }
+    if (target != dir) {
+      directory.store(target);
+      epochs.Retire(dir);
+    }
+    EndWrite(*cur);
+    // the key's bucket may still be full, so loop until there is room for it
+  }
+}
 
-      for (size_t i = 0;
-           i < directories.size(); i++) {  // assign each directory point to the correct the bucket
-        if (directories[i] == cur && (i & mask)) {
-          directories[i] = newBuc;
+/*
+ * batched Insert: each bucket is latched once for all of its keys. A key
+ * that does not fit, or that a split moved since the keys were grouped, is
+ * inserted on its own afterwards
+ */
+template<typename K, typename V>
+void ExtendibleHash<K, V>::InsertBatch(const vector<K> &keys,
+                                       const vector<V> &values) {
+  if (keys.size() == 1) {
+    Insert(keys[0], values[0]);
+    return;
+  }
+  vector<size_t> pending;
+  {
+    EpochGuard guard(epochs);
+    vector<BatchKey> batch;
+    GroupByBucket(keys, batch);
+    for (size_t begin = 0, end; begin < batch.size(); begin = end) {
+      end = GroupEnd(batch, begin);
+      unique_lock<mutex> lck;
+      Bucket *cur = LatchBucket(keys[batch[begin].index], lck);
+      // the entries of a latched bucket stay put
+      Directory *dir = directory.load(memory_order_acquire);
+      const size_t mask = dir->entries.size() - 1;
+      BeginWrite(*cur);
+      for (size_t k = begin; k < end; k++) {
+        PrefetchAhead(batch, k);
+        size_t i = batch[k].index;
+        if (dir->entries[batch[k].hash & mask].load(memory_order_relaxed) !=
+            cur) {
+          pending.push_back(i);
+          continue;
+        }
+        const uint8_t fingerprint = Fingerprint(batch[k].hash);
+        int slot = FindSlot(*cur, fingerprint, keys[i]);
+        if (slot >= 0) {
+          cur->values[slot] = values[i];
+          continue;
         }
+        slot = FindEmptySlot(*cur);
+        if (slot < 0) {
+          pending.push_back(i);
+          continue;
+        }
+        cur->fingerprints[slot] = fingerprint;
+        cur->keys[slot] = keys[i];
+        cur->values[slot] = values[i];
+        cur->size++;
       }
+      EndWrite(*cur);
     }
-    idx = getIdx(key);
-    cur = directories[idx];  // get the current bucket, maybe it's still full so we need use while loop, until we find the empty position for the key.
+  }
+  for (size_t i : pending) {
+    Insert(keys[i], values[i]);
   }
 }
 
@@ -0,0 +1,232 @@
+#include <thread>
+
+#include "hash/linear_probe_hash_table.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * constructor
+ * expected_size: number of entries the table should hold without growing,
+ * e.g. the number of frames of a buffer pool
+ */
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::LinearProbeHashTable(size_t expected_size) {
+  size_t capacity = 16;
+  while (capacity < 2 * expected_size) {
+    capacity <<= 1;
+  }
+  table_.store(new Table(capacity));
+}
+
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::~LinearProbeHashTable() {
+  delete table_.load();
+  for (auto table : retired_) {
+    delete table;
+  }
+}
+
+/*
+ * helper function to calculate the hashing address of input key; the
+ * multiplication spreads consecutive keys (page ids) across the table
+ */
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::HashKey(const K &key) const {
+  uint64_t h = static_cast<uint64_t>(std::hash<K>{}(key));
+  h *= 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(h ^ (h >> 32));
+}
+
+/*
+ * lookup function to find value associate with input key, without locking.
+ * Retries while a writer is changing the table or if one changed it during
+ * the probe
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Find(const K &key, V &value) {
+  const size_t hash = HashKey(key);
+  while (true) {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    if (version & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    Table *table = table_.load(std::memory_order_acquire);
+    bool found = false;
+    V result{};
+    for (size_t i = hash & table->mask, n = 0; n <= table->mask;
+         i = (i + 1) & table->mask, ++n) {
+      Slot &slot = table->slots[i];
+      if (!slot.used.load(std::memory_order_relaxed)) {
+        break;
+      }
+      if (slot.key.load(std::memory_order_relaxed) == key) {
+        result = slot.value.load(std::memory_order_relaxed);
+        found = true;
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) == version) {
+      if (found) {
+        value = result;
+      }
+      return found;
+    }
+  }
+}
+
+/*
+ * Find of every key, with the home slot of the key PREFETCH_DISTANCE lookups
+ * ahead prefetched so that the misses overlap. Outgrown tables stay allocated,
+ * the prefetch address is always valid
+ */
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::FindBatch(const std::vector<K> &keys,
+                                             std::vector<V> &values,
+                                             std::vector<bool> &found) {
+  const size_t PREFETCH_DISTANCE = 8;
+  const size_t n = keys.size();
+  values.assign(n, V());
+  found.assign(n, false);
+  Table *table = table_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < n && i < PREFETCH_DISTANCE; ++i) {
+    __builtin_prefetch(&table->slots[HashKey(keys[i]) & table->mask]);
+  }
+  size_t hits = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (i + PREFETCH_DISTANCE < n) {
+      __builtin_prefetch(
+          &table->slots[HashKey(keys[i + PREFETCH_DISTANCE]) & table->mask]);
+    }
+    V value;
+    if (Find(keys[i], value)) {
+      values[i] = value;
+      found[i] = true;
+      hits++;
+    }
+  }
+  return hits;
+}
+
+/*
+ * delete <key,value> entry in hash table, the entries after it in the same
+ * cluster that probed past its slot are shifted back so that no probe
+ * sequence is broken
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Remove(const K &key) {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  Table *table = table_.load(std::memory_order_relaxed);
+  const size_t mask = table->mask;
+  size_t i = HashKey(key) & mask;
+  while (true) {
+    Slot &slot = table->slots[i];
+    if (!slot.used.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    if (slot.key.load(std::memory_order_relaxed) == key) {
+      break;
+    }
+    i = (i + 1) & mask;
+  }
+
+  uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+    Slot &next = table->slots[j];
+    if (!next.used.load(std::memory_order_relaxed)) {
+      break;
+    }
+    // distance from the home slot, an entry may move back to i only if it
+    // does not pass its home slot
+    K next_key = next.key.load(std::memory_order_relaxed);
+    size_t home = HashKey(next_key) & mask;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      table->slots[i].key.store(next_key, std::memory_order_relaxed);
+      table->slots[i].value.store(next.value.load(std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+      i = j;
+    }
+  }
+  table->slots[i].used.store(false, std::memory_order_relaxed);
+  --size_;
+  version_.store(version + 2, std::memory_order_release);
+  return true;
+}
+
+/*
+ * insert <key,value> entry in hash table, overwriting the value of an
+ * existing key. Grows the table past a load factor of 3/4
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::Insert(const K &key, const V &value) {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  if (4 * (size_ + 1) > 3 * (table_.load(std::memory_order_relaxed)->mask + 1)) {
+    Grow();
+  }
+  InsertInto(table_.load(std::memory_order_relaxed), key, value);
+  version_.store(version + 2, std::memory_order_release);
+}
+
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::InsertInto(Table *table, const K &key,
+                                            const V &value) {
+  for (size_t i = HashKey(key) & table->mask;; i = (i + 1) & table->mask) {
+    Slot &slot = table->slots[i];
+    if (!slot.used.load(std::memory_order_relaxed)) {
+      slot.key.store(key, std::memory_order_relaxed);
+      slot.value.store(value, std::memory_order_relaxed);
+      slot.used.store(true, std::memory_order_relaxed);
+      ++size_;
+      return;
+    }
+    if (slot.key.load(std::memory_order_relaxed) == key) {
+      slot.value.store(value, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+/*
+ * double the capacity. The old table is kept until destruction because a
+ * reader may still be probing it; its retry then moves to the new one
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::Grow() {
+  Table *old_table = table_.load(std::memory_order_relaxed);
+  Table *new_table = new Table(2 * (old_table->mask + 1));
+  size_ = 0;
+  for (size_t i = 0; i <= old_table->mask; ++i) {
+    Slot &slot = old_table->slots[i];
+    if (slot.used.load(std::memory_order_relaxed)) {
+      InsertInto(new_table, slot.key.load(std::memory_order_relaxed),
+                 slot.value.load(std::memory_order_relaxed));
+    }
+  }
+  table_.store(new_table, std::memory_order_release);
+  retired_.push_back(old_table);
+}
+
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::GetSize() {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  return size_;
+}
+
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::GetCapacity() {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  return table_.load(std::memory_order_relaxed)->mask + 1;
+}
+
+template class LinearProbeHashTable<page_id_t, Page *>;
+
+// test purpose
+template class LinearProbeHashTable<int, int>;
+} // namespace cmudb
@@ -0,0 +1,85 @@
+/**
+ * arc_replacer.h
+ *
+ * Functionality: Adaptive Replacement Cache. Resident frames live in one of two
+ * LRU lists: T1 holds pages referenced once since they were loaded (recency),
+ * T2 pages referenced again (frequency). When a page is evicted its page id is
+ * remembered in the matching ghost list, B1 or B2. A later miss on a ghost page
+ * shows which side would have kept it and moves the target size p of T1 toward
+ * that side, so the split between recency and frequency follows the workload.
+ *
+ * The buffer pool reports loads through Load(frame, page_id); that is where
+ * ghost hits are detected. As in the other replacers a reference is counted on
+ * Insert (unpin), and Erase (pin) keeps the frame in its list.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ARCReplacer : public Replacer<T> {
+  enum class ListType { T1, T2 };
+  struct FrameInfo {
+    ListType list = ListType::T1;
+    typename std::list<T>::iterator pos;
+    page_id_t page_id = INVALID_PAGE_ID;
+    bool evictable = false;
+    bool referenced = false; // unpinned at least once since it was loaded
+  };
+
+public:
+  explicit ARCReplacer(size_t capacity);
+
+  ~ARCReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool PreferredVictim(T &value, const std::function<bool(const T &)> &prefer);
+
+  bool VictimIf(T &value, const std::function<bool(const T &)> &accept);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void Load(const T &value, page_id_t page_id);
+
+  // introspection, to compare the policy with others on a live workload
+  size_t GetTarget();         // current target size p of T1
+  size_t GetRecencyHits();    // re-references to pages in T1
+  size_t GetFrequencyHits();  // re-references to pages in T2
+  size_t GetGhostHits(bool frequency); // misses found in B2 (true) / B1 (false)
+
+private:
+  bool ChooseVictim(T &value, const std::function<bool(const T &)> &prefer);
+  bool EvictFrom(std::list<T> &list, std::list<page_id_t> &ghost,
+                 std::unordered_map<page_id_t,
+                                    std::list<page_id_t>::iterator> &ghost_map,
+                 T &value, const std::function<bool(const T &)> &prefer);
+  void DropGhost(std::list<page_id_t> &ghost,
+                 std::unordered_map<page_id_t,
+                                    std::list<page_id_t>::iterator> &ghost_map);
+
+  size_t capacity_;
+  size_t target_ = 0;
+  size_t evictable_count_ = 0;
+  // resident lists, most recently used at the front
+  std::list<T> t1_, t2_;
+  std::unordered_map<T, FrameInfo> frames_;
+  // ghost lists of evicted page ids, most recently evicted at the front
+  std::list<page_id_t> b1_, b2_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> b1_map_, b2_map_;
+  size_t recency_hits_ = 0, frequency_hits_ = 0;
+  size_t b1_hits_ = 0, b2_hits_ = 0;
+  std::mutex latch_;
+};
+
+} // namespace cmudb
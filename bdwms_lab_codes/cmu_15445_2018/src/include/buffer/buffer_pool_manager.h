@@ -4,46 +4,284 @@
  * Functionality: The simplified Buffer Manager interface allows a client to
  * new/delete pages on disk, to read a disk page into the buffer pool and pin
  * it, also to unpin a page in the buffer pool.
+ *
+ * A FetchPage of a resident page takes no latch: the page table is looked up
+ * without locking and the frame is pinned with a CAS on its pin count. UnpinPage
+ * takes no latch either. Frames stay in the replacer while they are pinned and
+ * a hit only sets the frame's reference bit, which the next eviction turns
+ * into the replacer update. Misses, evictions and deletions take latch_.
+ *
+ * FetchPageRead/FetchPageWrite return a ReadPageGuard/WritePageGuard that
+ * holds the pin and the latch of the page and releases both when it goes out
+ * of scope, without looking the page up again.
+ *
+ * Frames are sized by the page size of the disk manager's database file. Their
+ * content lives in one page aligned FrameArena, apart from the Page metadata.
+ *
+ * When constructed with num_instances > 1 the pool is partitioned: it owns no
+ * frames itself and routes every call to one of num_instances independent
+ * BufferPoolManagers (page_id % num_instances), each with its own frames, page
+ * table, replacer, free list and latch.
+ *
+ * Constructed from a list of region sizes the pool is split into regions with
+ * independent capacity, one BufferPoolManager each (partitioned if
+ * num_instances > 1), e.g. PoolRegion::INDEX for B+tree pages so that a heap
+ * scan cannot evict the upper levels of the indexes. A client picks its
+ * region by the handle it uses, GetRegion(region); the pool itself acts as the
+ * DATA region. A page is resident in at most one region: a region that misses
+ * looks in the others first, under a latch striped by page id.
+ *
+ * Retain keeps an extra pin of the pool on a page the caller has pinned, so
+ * that it is never evicted, for at most half of the frames and only while
+ * memory allows: when no victim is left, the retained pages are let go.
+ *
+ * RunPageCleaner starts a background thread (one per instance) that writes
+ * dirty, unpinned pages back ahead of eviction, so that a FetchPage/NewPage
+ * miss can usually reuse a clean frame instead of writing to disk while it
+ * holds the latch.
+ *
+ * Prefetch queues pages for a background reader (one per instance, started on
+ * first use) that loads them into frames without pinning them, so scans can
+ * ask for the next pages before they need them. The reader takes up to
+ * PREFETCH_BATCH_PAGES queued pages at a time and reads them with
+ * asynchronous I/O submitted together, so they are all in flight at once; the
+ * page cleaner writes its pages the same way.
+ *
+ * Pages fetched (or prefetched) with AccessHint::SEQUENTIAL that miss are read
+ * into a small ring of at most SEQUENTIAL_RING_SIZE frames that is recycled
+ * instead of going through the replacer, so a full scan does not push the
+ * working set out of the pool.
+ *
+ * FlushAllPages writes every dirty page back for a checkpoint or shutdown:
+ * the pages are sorted by page id, runs of consecutive pages go to disk in
+ * one write each and the file is synced once at the end. FlushPages does the
+ * same for at most a byte budget of pages, resuming where the previous call
+ * stopped, so a checkpoint can be spread over time.
+ *
+ * SaveResidentPages records the ids of the resident pages, most recently used
+ * first, so that WarmUp can read them back in after a restart: sorted by page
+ * id, in large reads, and handed to the replacer in their old recency order.
+ * RunResidentPageSaver saves them every WARM_UP_SAVE_TIMEOUT and a last time
+ * when it is stopped.
+ *
+ * Resize changes the number of frames at runtime, up to the number the pool
+ * was constructed with: frames above the new size go offline (their memory is
+ * returned to the OS) and come back when the pool grows again. A shrink takes
+ * free frames offline at once; a background thread moves the pages of the
+ * other ones into free frames, or evicts them, as they become unpinned, one
+ * frame per latch_ acquisition.
+ *
+ * EnableCompressedCache puts a CompressedPageCache behind the pool: evicted
+ * pages are kept there compressed and a miss looks there before it reads the
+ * disk, so the pool holds more pages than it has frames at the cost of some
+ * CPU per miss.
+ *
+ * GetStats reads the counters of the pool (summed over all instances of a
+ * partitioned pool): hits, misses, evictions, write-backs, latch waits.
  */
 
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <string>
 #include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
+#include "hash/linear_probe_hash_table.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace cmudb {
+
+// replacement policy used to choose a victim among the unpinned frames
+enum class ReplacerType { LRU, CLOCK, LRU_K, ARC };
+
+// regions of a pool built from region sizes, in that order
+enum class PoolRegion { DATA, INDEX };
+
+// how the caller is going to access the page; SEQUENTIAL pages are read once
+// and then not needed again, e.g. by a full table scan
+enum class AccessHint { NORMAL, SEQUENTIAL };
+
 class BufferPoolManager {
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
  public:
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr,
+                    size_t num_instances = 1,
+                    ReplacerType replacer_type = ReplacerType::LRU,
+                    bool prefault = false);
+
+  // one region per size, region i is PoolRegion(i)
+  BufferPoolManager(const std::vector<size_t> &region_sizes,
+                    DiskManager *disk_manager,
+                    LogManager *log_manager = nullptr,
+                    size_t num_instances = 1,
+                    ReplacerType replacer_type = ReplacerType::LRU,
+                    bool prefault = false);
 
   ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  // the pool to use for pages of region, this pool if it has no regions
+  BufferPoolManager *GetRegion(PoolRegion region);
+
+  Page *FetchPage(page_id_t page_id, AccessHint hint = AccessHint::NORMAL);
 
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
+  // fetch, pin and latch; the guard is empty if the page cannot be fetched
+  ReadPageGuard FetchPageRead(page_id_t page_id,
+                              AccessHint hint = AccessHint::NORMAL);
+  WritePageGuard FetchPageWrite(page_id_t page_id,
+                                AccessHint hint = AccessHint::NORMAL);
+
   bool FlushPage(page_id_t page_id);
 
+  // write back dirty pages, sorted and coalesced; return the number written.
+  // The caller must not hold a page latch
+  size_t FlushAllPages();
+  size_t FlushPages(size_t byte_budget);
+
   Page *NewPage(page_id_t &page_id);
 
   bool DeletePage(page_id_t page_id);
 
   bool CheckAllUnpined();
+
+  // keep a page the caller has pinned resident, false if there is no room
+  bool Retain(Page *page);
+
+  // keep at least clean_fraction of the frames clean in the background
+  void RunPageCleaner(double clean_fraction = 0.5);
+  void StopPageCleaner();
+
+  // asynchronously read pages into the pool without pinning them, best effort
+  void Prefetch(page_id_t first, size_t n,
+                AccessHint hint = AccessHint::NORMAL);
+  void Prefetch(const std::vector<page_id_t> &page_ids,
+                AccessHint hint = AccessHint::NORMAL);
+
+  // number of frames, at most the constructed pool size, see Resize
+  bool Resize(size_t pool_size);
+  size_t GetPoolSize();
+
+  // second tier of capacity bytes for compressed evicted pages, to be called
+  // before the pool is used
+  void EnableCompressedCache(size_t capacity);
+
+  // warm-up after a restart, see SaveResidentPages/WarmUp
+  bool SaveResidentPages(const std::string &file_name);
+  size_t WarmUp(const std::string &file_name);
+  void RunResidentPageSaver(const std::string &file_name);
+  void StopResidentPageSaver();
+
+  // FetchPage hit ratio of the whole pool, to compare replacement policies
+  double GetHitRatio();
+  BufferPoolStats GetStats();
+  inline ReplacerType GetReplacerType() const { return replacer_type_; }
+  inline size_t GetPageSize() const { return page_size_; }
  private:
-  size_t pool_size_; // number of pages in buffer pool
-  Page *pages_;      // array of pages
+  std::atomic<size_t> pool_size_; // number of pages in buffer pool
+  size_t capacity_;  // number of frames, pool_size_ of them online
+  size_t page_size_; // size of a page in byte
+  FrameArena frame_arena_; // page content of all frames, page_size_ each
+  Page *pages_;             // array of pages
   DiskManager *disk_manager_;
   LogManager *log_manager_;
   HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
   Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
   std::list<Page *> *free_list_; // to find a free page for replacement
   std::mutex latch_;             // to protect shared data structure
+  ReplacerType replacer_type_;
+  BufferPoolCounters counters_;
+  std::unique_lock<std::mutex> LockLatch(); // lock latch_, timing any wait
+  Page *FetchPageLocal(page_id_t page_id, AccessHint hint);
   Page *GetVictimPage();         // to get a page that will be replaced
+  // latch-free hit path
+  bool UnpinFrame(Page *p, bool is_dirty);   // also for page guards
+  bool TryPin(Page *p, page_id_t page_id);
+  bool Claim(Page *p);                       // caller holds latch_
+  // sequential access
+  Page *GetFrame(AccessHint hint);
+  void LeaveRing(Page *p);
+  std::vector<Page *> ring_; // frames recycled by sequential access
+  size_t ring_hand_ = 0;
+  void WriteBackVictim(Page *p); // caller holds latch_
+  // compressed second tier, shared by all instances
+  void SetCompressedCache(CompressedPageCache *cache);
+  void ReadPageData(page_id_t page_id, char *data); // cache, else disk
+  CompressedPageCache *compressed_cache_ = nullptr;
+  bool owns_compressed_cache_ = false;
+  // sorted write-back
+  void CollectDirtyPages(std::vector<std::pair<page_id_t, Page *>> &dirty);
+  void PinForFlush(std::vector<std::pair<page_id_t, Page *>> &dirty);
+  size_t FlushSorted(page_id_t from, size_t max_pages);
+  std::mutex flush_latch_;       // one FlushAllPages/FlushPages at a time
+  page_id_t flush_cursor_ = 0;   // where the next FlushPages starts
+  // warm-up
+  void CollectResidentPages(
+      std::vector<std::pair<int64_t, page_id_t>> &resident);
+  Page *InstallPage(page_id_t page_id, const char *data);
+  void AdmitPages(const std::vector<std::pair<page_id_t, Page *>> &pages);
+  std::thread *saver_thread_ = nullptr;
+  bool saver_running_ = false;
+  std::string saver_file_;
+  std::mutex saver_latch_;             // protects the three above
+  std::condition_variable saver_cv_;
+  // page cleaner
+  size_t CleanPages();
+  std::thread *cleaner_thread_ = nullptr;
+  std::atomic<bool> cleaner_running_{false};
+  std::condition_variable cleaner_cv_; // wakes the cleaner early, with latch_
+  double clean_fraction_ = 0;
+  size_t cleaner_hand_ = 0;            // next frame the cleaner looks at
+  // prefetch
+  void LoadPages(const std::vector<std::pair<page_id_t, AccessHint>> &requests);
+  std::thread *prefetch_thread_ = nullptr;
+  bool prefetch_stop_ = false;
+  std::deque<std::pair<page_id_t, AccessHint>> prefetch_queue_; // bounded by pool_size_
+  std::mutex prefetch_latch_;            // protects the three above
+  std::condition_variable prefetch_cv_;
+  // partitioned pool only: independent instances that own the frames
+  std::vector<BufferPoolManager *> instances_;
+  BufferPoolManager *GetInstance(page_id_t page_id);
+  bool OwnsFrame(Page *p);
+  // regions: instances_ are the regions of a pool built from region sizes
+  bool has_regions_ = false;
+  BufferPoolManager *regions_owner_ = nullptr; // set in each region
+  std::mutex region_latches_[16]; // misses of a page id, across regions
+  bool IsResident(page_id_t page_id);
+  Page *PinResident(page_id_t page_id);
+  Page *PinInAnyRegion(page_id_t page_id);
+  // retained pages, under latch_
+  size_t num_retained_ = 0;
+  void ReleaseRetained();
+  // resizing; frames above pool_size_ go offline, under latch_
+  std::vector<bool> offline_;
+  std::atomic<size_t> num_online_{0};
+  bool ShrinkFrames();
+  bool OfflineFrame(Page *p);
+  std::thread *shrink_thread_ = nullptr;
+  bool shrink_stop_ = false;
+  bool shrink_pending_ = false;
+  std::mutex shrink_latch_;            // protects the two above
+  std::condition_variable shrink_cv_;
+  Page *NewPageWithId(page_id_t page_id);
+  Page *InitNewPage(Page *p, page_id_t page_id);
 };
 } // namespace cmudb
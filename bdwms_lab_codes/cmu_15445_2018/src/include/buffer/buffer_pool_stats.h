@@ -0,0 +1,109 @@
+/**
+ * buffer_pool_stats.h
+ *
+ * Counters of a buffer pool instance and the snapshot they are read into.
+ *
+ * BufferPoolCounters is updated on the hot paths (a FetchPage hit included),
+ * so every counter is striped: each thread adds to its own cache line and a
+ * read sums the stripes. Latch waits are timed only when latch_ is contended
+ * and go into a histogram of power-of-two microsecond buckets.
+ *
+ * BufferPoolStats is a plain snapshot; the snapshots of the instances of a
+ * partitioned pool add up, and ToString/ToJson dump one for scraping. The
+ * compressed cache keeps its own counters, the pool copies them in.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cmudb {
+
+#define STATS_STRIPES 16       // cache lines a striped counter is spread over
+#define LATCH_WAIT_BUCKETS 16  // bucket i: wait < 2^i us, the last one: rest
+
+/*
+ * A counter that threads add to without sharing a cache line (in the common
+ * case), read by summing all stripes
+ */
+class StripedCounter {
+public:
+  inline void Add(uint64_t n = 1) {
+    stripes_[ThreadStripe()].value.fetch_add(n, std::memory_order_relaxed);
+  }
+  uint64_t Load() const;
+
+private:
+  static size_t ThreadStripe();
+  // padded rather than aligned: C++14 new ignores extended alignment
+  struct Stripe {
+    std::atomic<uint64_t> value{0};
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+  Stripe stripes_[STATS_STRIPES];
+};
+
+struct BufferPoolStats {
+  uint64_t fetch_hits = 0;        // FetchPage found the page resident
+  uint64_t fetch_misses = 0;      // FetchPage had to read the page
+  uint64_t evictions = 0;         // a resident page gave its frame away
+  uint64_t dirty_writebacks = 0;  // evicted pages that had to be written
+  uint64_t cleaner_writebacks = 0; // pages written by the page cleaner
+  uint64_t flushed_pages = 0;     // pages written by FlushAllPages/FlushPages
+  uint64_t eviction_log_flushes = 0; // WAL forced the log out before a write
+  uint64_t pin_failures = 0;      // no frame could be freed, all pinned
+  uint64_t dirty_pages = 0;       // dirty frames at the time of the snapshot
+  uint64_t pool_frames = 0;       // frames not offline at the snapshot
+  uint64_t pool_grows = 0;        // Resize calls that added frames
+  uint64_t pool_shrinks = 0;      // Resize calls that removed frames
+  uint64_t shrink_migrations = 0; // pages moved out of a frame going offline
+  uint64_t shrink_evictions = 0;  // pages evicted from a frame going offline
+  uint64_t latch_acquisitions = 0;
+  uint64_t latch_waits = 0;       // acquisitions that found latch_ held
+  uint64_t latch_wait_us = 0;     // total time spent waiting
+  uint64_t latch_wait_histogram[LATCH_WAIT_BUCKETS] = {};
+  // compressed cache, see BufferPoolManager::EnableCompressedCache
+  uint64_t compressed_hits = 0;   // misses served by the compressed cache
+  uint64_t compressed_misses = 0; // misses that had to read the disk
+  uint64_t compressed_pages = 0;  // pages in the cache at the snapshot
+  uint64_t compressed_bytes = 0;  // their compressed size
+
+  double GetHitRatio() const;
+  double GetCompressedHitRatio() const;
+  BufferPoolStats &operator+=(const BufferPoolStats &other);
+  std::string ToString() const;
+  std::string ToJson() const;
+};
+
+class BufferPoolCounters {
+public:
+  StripedCounter fetch_hits;
+  StripedCounter fetch_misses;
+  StripedCounter evictions;
+  StripedCounter dirty_writebacks;
+  StripedCounter cleaner_writebacks;
+  StripedCounter flushed_pages;
+  StripedCounter eviction_log_flushes;
+  StripedCounter pin_failures;
+  StripedCounter latch_acquisitions;
+  StripedCounter pool_grows;
+  StripedCounter pool_shrinks;
+  StripedCounter shrink_migrations;
+  StripedCounter shrink_evictions;
+
+  // called after latch_ had to be waited for
+  void RecordLatchWait(std::chrono::steady_clock::duration wait);
+  // everything but dirty_pages and pool_frames, which the pool counts itself
+  BufferPoolStats Snapshot() const;
+
+private:
+  std::atomic<uint64_t> latch_waits_{0};
+  std::atomic<uint64_t> latch_wait_us_{0};
+  std::atomic<uint64_t> latch_wait_histogram_[LATCH_WAIT_BUCKETS] = {};
+};
+
+} // namespace cmudb
@@ -0,0 +1,56 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK approximation of LRU. The replacer tracks a fixed set of
+ * num_frames values first_frame, first_frame + 1, ... (frame pointers into the
+ * buffer pool's page array, or plain frame ids), so all bookkeeping lives in
+ * two arrays indexed by frame id: whether the frame is evictable and its
+ * reference bit. Insert/Erase are O(1) and never allocate; Victim sweeps the
+ * clock hand, clearing reference bits until it finds an unreferenced frame.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ClockReplacer : public Replacer<T> {
+public:
+  explicit ClockReplacer(size_t num_frames, T first_frame = T());
+
+  ~ClockReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool PreferredVictim(T &value, const std::function<bool(const T &)> &prefer);
+
+  bool VictimIf(T &value, const std::function<bool(const T &)> &accept);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+private:
+  bool Sweep(T &value, const std::function<bool(const T &)> &prefer,
+             size_t max_steps);
+  inline size_t FrameId(const T &value) const {
+    return static_cast<size_t>(value - first_frame_);
+  }
+
+  T first_frame_;
+  size_t num_frames_;
+  std::vector<uint8_t> in_replacer_; // frame is unpinned and can be evicted
+  std::vector<uint8_t> ref_bit_;     // frame was unpinned since the last sweep
+  size_t hand_ = 0;
+  size_t size_ = 0;
+  std::mutex latch_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,64 @@
+/**
+ * compressed_page_cache.h
+ *
+ * Second tier behind the buffer pool: clean pages that were evicted are kept
+ * here compressed (LZCodec), so that a later miss can decompress them instead
+ * of reading the disk. A page is either resident in the pool or cached here,
+ * never both: the pool takes it out on a miss and puts it in on eviction,
+ * after any write-back, so the cached copy always equals the one on disk.
+ *
+ * The cache holds at most capacity bytes of compressed pages and drops the
+ * ones that were evicted from the pool the longest ago. Pages that do not
+ * compress are kept as they are. It has its own latch and is shared by all
+ * instances of a partitioned pool.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class CompressedPageCache {
+public:
+  CompressedPageCache(size_t capacity, size_t page_size);
+  CompressedPageCache(const CompressedPageCache &) = delete;
+  CompressedPageCache &operator=(const CompressedPageCache &) = delete;
+
+  // keep a copy of the page_size bytes of data
+  void Insert(page_id_t page_id, const char *data);
+  // move page_id out of the cache into data, false if it is not cached
+  bool Take(page_id_t page_id, char *data);
+  void Erase(page_id_t page_id);
+
+  inline uint64_t GetHits() const { return hits_; }
+  inline uint64_t GetMisses() const { return misses_; }
+  size_t GetNumPages();
+  // bytes of compressed page data held
+  size_t GetBytes();
+  inline size_t GetCapacity() const { return capacity_; }
+
+private:
+  struct Entry {
+    page_id_t page_id;
+    std::vector<char> data;  // page_size_ bytes: stored uncompressed
+  };
+  void EraseEntry(std::list<Entry>::iterator it);
+
+  const size_t capacity_;
+  const size_t page_size_;
+  std::mutex latch_;
+  std::list<Entry> entries_;  // most recently inserted first
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+  size_t bytes_ = 0;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace cmudb
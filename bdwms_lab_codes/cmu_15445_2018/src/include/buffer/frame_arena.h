@@ -0,0 +1,46 @@
+/**
+ * frame_arena.h
+ *
+ * One contiguous, page aligned block of memory that holds the content of all
+ * frames of a buffer pool, while the Page objects only keep the bookkeeping.
+ *
+ * The block is mapped anonymously (so it starts zeroed) and, if it is large
+ * enough, aligned to and advised for transparent huge pages, so that a big
+ * pool is covered by a few TLB entries. With prefault every page of the block
+ * is touched up front instead of on the first access to each frame.
+ *
+ * Discard gives the memory of a range back to the OS, for a pool that shrinks;
+ * the range reads back zeroed and is backed again on its next use.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace cmudb {
+
+// size of a transparent huge page on x86-64 and most aarch64 kernels
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+class FrameArena {
+public:
+  explicit FrameArena(size_t size, bool prefault = false);
+  ~FrameArena();
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  inline char *GetData() { return data_; }
+  inline size_t GetSize() const { return size_; }
+  // release the OS pages that lie entirely within [offset, offset + size)
+  void Discard(size_t offset, size_t size);
+  // true if the kernel was asked to back the arena with huge pages
+  inline bool IsHugePageAdvised() const { return huge_page_advised_; }
+
+private:
+  char *data_ = nullptr;
+  size_t size_;        // bytes requested by the caller
+  size_t mapped_size_; // bytes actually mapped, size_ rounded up
+  bool huge_page_advised_ = false;
+};
+
+} // namespace cmudb
@@ -0,0 +1,68 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement. For every frame the replacer remembers the
+ * times of its last K uncorrelated references and evicts the unpinned frame
+ * whose K-th most recent reference is the oldest (largest backward K-distance).
+ * Frames with fewer than K references have an infinite K-distance and are
+ * evicted first, oldest reference first, so a page touched once by a
+ * sequential scan leaves before a page that is referenced again and again.
+ *
+ * Time is a logical clock advanced by every Insert (unpin). A reference that
+ * comes within correlated_period ticks of the previous reference to the same
+ * frame (e.g. consecutive tuples read from one heap page) is correlated: it
+ * only refreshes the last reference instead of adding to the history.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+  struct FrameHistory {
+    std::deque<uint64_t> history; // last k uncorrelated references, oldest first
+    uint64_t last = 0;            // most recent reference, correlated or not
+    bool evictable = false;
+    std::pair<int, uint64_t> key; // position in evictable_ when evictable
+  };
+
+public:
+  explicit LRUKReplacer(size_t k = 2, uint64_t correlated_period = 1);
+
+  ~LRUKReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool PreferredVictim(T &value, const std::function<bool(const T &)> &prefer);
+
+  bool VictimIf(T &value, const std::function<bool(const T &)> &accept);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void Load(const T &value, page_id_t page_id);
+
+private:
+  size_t k_;
+  uint64_t correlated_period_;
+  uint64_t current_time_ = 0;
+  std::unordered_map<T, FrameHistory> frames_;
+  // evictable frames ordered by eviction priority: frames with less than k
+  // references (0) before the others (1), then by the oldest kept reference
+  std::map<std::pair<int, uint64_t>, T> evictable_;
+  std::mutex latch_;
+};
+
+} // namespace cmudb
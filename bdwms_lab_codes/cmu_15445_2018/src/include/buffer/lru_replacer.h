@@ -35,6 +35,10 @@ class LRUReplacer : public Replacer<T> {
 
   bool Victim(T &value);
 
+  bool PreferredVictim(T &value, const std::function<bool(const T &)> &prefer);
+
+  bool VictimIf(T &value, const std::function<bool(const T &)> &accept);
+
   bool Erase(const T &value);
 
   size_t Size();
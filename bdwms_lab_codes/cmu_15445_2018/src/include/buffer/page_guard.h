@@ -0,0 +1,77 @@
+/**
+ * page_guard.h
+ *
+ * RAII handles on a pinned and latched page, returned by
+ * BufferPoolManager::FetchPageRead/FetchPageWrite. A guard owns the pin and
+ * the latch of its frame and gives both back when it is destroyed, released
+ * or assigned another page; it remembers the frame, so releasing it needs no
+ * page table lookup. Guards are move-only.
+ */
+
+#pragma once
+
+#include "page/page.h"
+
+namespace cmudb {
+
+class BufferPoolManager;
+
+class ReadPageGuard {
+public:
+  ReadPageGuard() = default;
+  // adopt a page that is already pinned and read latched
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+  ReadPageGuard(ReadPageGuard &&that);
+  ReadPageGuard &operator=(ReadPageGuard &&that);
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ~ReadPageGuard() { Release(); }
+
+  // unlatch and unpin now, the guard becomes empty
+  void Release();
+
+  inline explicit operator bool() const { return page_ != nullptr; }
+  inline Page *GetPage() { return page_; }
+  inline page_id_t GetPageId() { return page_->GetPageId(); }
+  inline const char *GetData() { return page_->GetData(); }
+  template <typename T> inline const T *As() {
+    return reinterpret_cast<const T *>(page_->GetData());
+  }
+
+private:
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+};
+
+class WritePageGuard {
+public:
+  WritePageGuard() = default;
+  // adopt a page that is already pinned and write latched
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+  WritePageGuard(WritePageGuard &&that);
+  WritePageGuard &operator=(WritePageGuard &&that);
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  ~WritePageGuard() { Release(); }
+
+  // unlatch and unpin now, the guard becomes empty
+  void Release();
+
+  // the page is unpinned dirty unless told that it was not modified
+  inline void SetDirty(bool is_dirty) { is_dirty_ = is_dirty; }
+
+  inline explicit operator bool() const { return page_ != nullptr; }
+  inline Page *GetPage() { return page_; }
+  inline page_id_t GetPageId() { return page_->GetPageId(); }
+  inline char *GetData() { return page_->GetData(); }
+  template <typename T> inline T *As() {
+    return reinterpret_cast<T *>(page_->GetData());
+  }
+
+private:
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+  bool is_dirty_ = true;
+};
+
+} // namespace cmudb
@@ -6,6 +6,9 @@
 #pragma once
 
 #include <cstdlib>
+#include <functional>
+
+#include "common/config.h"
 
 namespace cmudb {
 
@@ -17,6 +20,19 @@ public:
   virtual bool Victim(T &value) = 0;
   virtual bool Erase(const T &value) = 0;
   virtual size_t Size() = 0;
+  // value now holds page_id (read on a miss or created by NewPage), policies
+  // that keep per-page history start over here
+  virtual void Load(const T &value, page_id_t page_id) {}
+  // like Victim, but take the first candidate in eviction order for which
+  // prefer holds, and the plain victim when there is none
+  virtual bool PreferredVictim(T &value,
+                               const std::function<bool(const T &)> &prefer) {
+    return Victim(value);
+  }
+  // like Victim, but only candidates that accept holds for can be evicted;
+  // return false if there is none
+  virtual bool VictimIf(T &value,
+                        const std::function<bool(const T &)> &accept) = 0;
 };
 
 } // namespace cmudb
@@ -14,17 +14,31 @@ namespace cmudb {
 
 extern std::chrono::duration<long long int, std::milli> LOG_TIMEOUT;
 
+extern std::chrono::duration<long long int, std::milli> PAGE_CLEANER_TIMEOUT;
+
+extern std::chrono::duration<long long int, std::milli> WARM_UP_SAVE_TIMEOUT;
+
+extern std::chrono::duration<long long int, std::milli> SHRINK_RETRY_TIMEOUT;
+
 extern std::atomic<bool> ENABLE_LOGGING;
 
 #define INVALID_PAGE_ID -1 // representing an invalid page id
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte
-#define LOG_BUFFER_SIZE                                                            \
-  ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
+#define PAGE_SIZE 512     // default size of a data page in byte, see DiskManager
+#define LOG_BUFFER_SIZE(page_size)                                             \
+  ((BUFFER_POOL_SIZE + 1) * (page_size)) // size of a log buffer in byte
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
-#define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define BUFFER_POOL_SIZE 10            // default size of buffer pool
+#define BUFFER_POOL_INSTANCES 1        // number of buffer pool partitions
+#define SEQUENTIAL_RING_SIZE 4         // frames recycled by sequential scans
+#define FLUSH_BATCH_PAGES 64           // most pages FlushAllPages writes at once
+#define WARM_UP_BATCH_PAGES 64         // most pages WarmUp reads at once
+#define PREFETCH_BATCH_PAGES 32        // most pages the prefetch reader reads at once
+#define CLEANER_BATCH_PAGES 32         // most pages the page cleaner writes at once
+#define ASYNC_IO_QUEUE_DEPTH 64        // most async page I/Os in flight per file
+#define ASYNC_IO_THREADS 4             // I/O threads when io_uring is unavailable
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
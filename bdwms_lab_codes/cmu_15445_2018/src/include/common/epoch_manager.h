@@ -0,0 +1,86 @@
+/**
+ * epoch_manager.h
+ *
+ * Epoch based reclamation, for memory that lock-free readers may still be
+ * looking at after a writer unlinked it.
+ *
+ * A reader holds an EpochGuard while it follows the shared pointers: entering
+ * claims a slot and records the global epoch in it. A writer unlinks an
+ * object and hands it to Retire, which tags it with the current epoch and
+ * advances the global one. The object is freed once no slot holds an epoch
+ * at or before its tag, i.e. every reader that could have seen it has left.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace cmudb {
+
+#define EPOCH_SLOTS 64  // readers that can be inside at the same time
+
+class EpochManager {
+  friend class EpochGuard;
+
+public:
+  EpochManager() = default;
+  // frees whatever is still retired; there must be no readers left
+  ~EpochManager();
+
+  EpochManager(const EpochManager &) = delete;
+  EpochManager &operator=(const EpochManager &) = delete;
+
+  // free ptr once the readers that might hold it are gone
+  template <typename T> void Retire(T *ptr) {
+    RetireCallback([ptr] { delete ptr; });
+  }
+  void RetireCallback(std::function<void()> free);
+
+  // free what no reader can hold any more
+  // @return: number of retired objects still waiting
+  size_t Reclaim();
+
+private:
+  size_t Enter();
+  void Exit(size_t slot);
+  uint64_t MinActiveEpoch() const;
+
+  // padded rather than aligned: C++14 new ignores extended alignment
+  struct Slot {
+    std::atomic<uint64_t> epoch{0}; // 0: no reader in this slot
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+  struct Retired {
+    uint64_t epoch;
+    std::function<void()> free;
+  };
+
+  std::atomic<uint64_t> global_epoch_{1};
+  Slot slots_[EPOCH_SLOTS];
+  std::mutex retired_latch_;
+  std::vector<Retired> retired_;
+};
+
+/*
+ * Keeps what the reader saw alive until it goes out of scope
+ */
+class EpochGuard {
+public:
+  explicit EpochGuard(EpochManager &manager)
+      : manager_(manager), slot_(manager.Enter()) {}
+  ~EpochGuard() { manager_.Exit(slot_); }
+
+  EpochGuard(const EpochGuard &) = delete;
+  EpochGuard &operator=(const EpochGuard &) = delete;
+
+private:
+  EpochManager &manager_;
+  size_t slot_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,36 @@
+/**
+ * lz_codec.h
+ *
+ * A small LZ77 codec in the spirit of LZ4, for compressing pages in memory.
+ *
+ * The output is a series of sequences, each a token byte (literal count in
+ * the high nibble, match length - LZ_MIN_MATCH in the low one), the literal
+ * count continued in 255-steps if the nibble is 15, the literals, a two byte
+ * little endian offset back into the output and the match length continued
+ * the same way. The last sequence has literals only and ends the input.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace cmudb {
+
+#define LZ_MIN_MATCH 4        // shortest match worth a sequence
+#define LZ_MAX_OFFSET 65535   // farthest a match can look back
+#define LZ_HASH_BITS 12       // size of the match finder table (log2)
+
+class LZCodec {
+public:
+  // compress size bytes of src into dst
+  // @return: compressed size, 0 if it would be larger than capacity
+  static size_t Compress(const char *src, size_t size, char *dst,
+                         size_t capacity);
+
+  // decompress size bytes of src into exactly dst_size bytes of dst
+  // @return: false if src is malformed or does not decompress to dst_size
+  static bool Decompress(const char *src, size_t size, char *dst,
+                         size_t dst_size);
+};
+
+} // namespace cmudb
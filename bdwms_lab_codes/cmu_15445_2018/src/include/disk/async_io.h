@@ -0,0 +1,144 @@
+/**
+ * async_io.h
+ *
+ * Asynchronous positional I/O on one file, the backend of the asynchronous
+ * page I/O of DiskManager. Read and Write queue a request; Submit hands every
+ * request queued since the previous Submit over at once (a full queue is
+ * submitted on its own). When a request is done its callback runs, on a
+ * thread of the backend, with whether it succeeded. At most queue_depth
+ * requests are in flight, Read and Write wait for room beyond that.
+ *
+ * IoUringIO uses an io_uring (Linux 5.1 and later, through the raw system
+ * calls): one io_uring_enter submits a whole batch, and a completion thread
+ * reaps the completions. ThreadPoolIO does the same with pread/pwrite on a few
+ * threads, for kernels (or sandboxes) without io_uring. Create picks the
+ * first one that works.
+ *
+ * A read that ends early at the end of the file zeroes the rest of the
+ * buffer and succeeds, as DiskManager::ReadPage does.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+namespace cmudb {
+
+// pwrite all of size bytes at offset, @return: false on I/O error
+bool WriteAt(int fd, const char *data, size_t size, size_t offset);
+// pread up to size bytes at offset, @return: number of bytes read
+size_t ReadAt(int fd, char *data, size_t size, size_t offset);
+
+class AsyncIO {
+public:
+  typedef std::function<void(bool)> Callback;
+
+  virtual ~AsyncIO() {}
+
+  virtual void Read(char *data, size_t size, size_t offset,
+                    Callback callback) = 0;
+  virtual void Write(const char *data, size_t size, size_t offset,
+                     Callback callback) = 0;
+  virtual void Submit() = 0;
+
+  // an io_uring if the kernel allows it, a thread pool otherwise
+  static AsyncIO *Create(int fd, size_t queue_depth, size_t num_threads);
+};
+
+class IoUringIO : public AsyncIO {
+public:
+  // Init tells whether the ring could be set up
+  IoUringIO(int fd, size_t queue_depth);
+  ~IoUringIO();
+  bool Init();
+
+  void Read(char *data, size_t size, size_t offset,
+            Callback callback) override;
+  void Write(const char *data, size_t size, size_t offset,
+             Callback callback) override;
+  void Submit() override;
+
+private:
+  struct Request {
+    bool write;
+    iovec iov;  // read by the kernel after io_uring_enter, so not on the stack
+    Callback callback;
+  };
+
+  void Queue(bool write, char *data, size_t size, size_t offset,
+             Callback callback);
+  void Enter(unsigned to_submit);  // caller holds sq_latch_
+  void Complete(Request *request, int result);
+  void ReapCompletions();
+
+  int fd_;
+  int ring_fd_ = -1;
+  size_t queue_depth_;
+  // mappings of the submission queue, its entries and the completion queue
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  // pointers into them
+  std::atomic<unsigned> *sq_tail_;
+  unsigned sq_mask_;
+  unsigned *sq_array_;
+  std::atomic<unsigned> *cq_head_;
+  std::atomic<unsigned> *cq_tail_;
+  unsigned cq_mask_;
+  void *cqes_;
+
+  std::mutex sq_latch_;        // protects the submission queue and the two below
+  unsigned unsubmitted_ = 0;   // queued since the last io_uring_enter
+  size_t in_flight_ = 0;       // queued and not completed yet
+  std::condition_variable room_cv_;  // in_flight_ went below queue_depth_
+  std::thread *completion_thread_ = nullptr;
+  bool stop_ = false;          // the completion thread returns when it sees it
+};
+
+class ThreadPoolIO : public AsyncIO {
+public:
+  ThreadPoolIO(int fd, size_t queue_depth, size_t num_threads);
+  ~ThreadPoolIO();
+
+  void Read(char *data, size_t size, size_t offset,
+            Callback callback) override;
+  void Write(const char *data, size_t size, size_t offset,
+             Callback callback) override;
+  void Submit() override;
+
+private:
+  struct Request {
+    bool write;
+    char *data;
+    size_t size;
+    size_t offset;
+    Callback callback;
+  };
+
+  void Queue(Request request);
+  void Run();
+
+  int fd_;
+  size_t queue_depth_;
+  std::mutex latch_;                 // protects everything below
+  std::vector<Request> unsubmitted_; // queued since the last Submit
+  std::deque<Request> submitted_;    // waiting for a thread
+  size_t in_flight_ = 0;             // queued and not completed yet
+  std::condition_variable work_cv_;  // submitted_ is not empty, or stop_
+  std::condition_variable room_cv_;  // in_flight_ went below queue_depth_
+  std::vector<std::thread> threads_;
+  bool stop_ = false;
+};
+
+} // namespace cmudb
@@ -5,25 +5,62 @@
  * database. It also performs read and write of pages to and from disk, and
  * provides a logical file layer within the context of a database management
  * system.
+ *
+ * The page size is chosen when the database file is created and recorded in
+ * the file header, which takes the first page_size bytes of the file; page n
+ * is stored at offset (n + 1) * page_size. Opening an existing file uses the
+ * page size it was created with.
+ *
+ * Pages are read and written with pread/pwrite on a file descriptor, so there
+ * is no shared file position and threads can do page I/O in parallel. A write
+ * only reaches the OS; Sync makes everything written so far durable with one
+ * fdatasync, and does nothing if nothing was written since the last one.
+ *
+ * ReadPageAsync and WritePageAsync queue a page I/O and return at once, with
+ * a future or a callback for its completion; SubmitAsync hands everything
+ * queued so far to the kernel together, so a caller can keep many page I/Os
+ * in flight. They go through an io_uring where the kernel allows it, through
+ * a few pread/pwrite threads otherwise (see AsyncIO), set up on first use.
+ * An asynchronous write counts for Sync once it has completed. Buffer pools
+ * do I/O from background threads, so a DiskManager has to outlive them.
  */
 
 #pragma once
 #include <atomic>
 #include <fstream>
+#include <functional>
 #include <future>
+#include <mutex>
 #include <string>
 
 #include "common/config.h"
 
 namespace cmudb {
 
+class AsyncIO;
+
 class DiskManager {
 public:
-  DiskManager(const std::string &db_file);
+  DiskManager(const std::string &db_file, size_t page_size = PAGE_SIZE);
   ~DiskManager();
 
   void WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
+  // num_pages consecutive pages from first_page_id on in one write
+  void WritePages(page_id_t first_page_id, const char *data, size_t num_pages);
+  // make the page writes so far durable
+  void Sync();
+  // queued until SubmitAsync (or until too many are queued); the future or
+  // callback tells whether the I/O succeeded
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+  void ReadPageAsync(page_id_t page_id, char *page_data,
+                     std::function<void(bool)> callback);
+  void WritePageAsync(page_id_t page_id, const char *page_data,
+                      std::function<void(bool)> callback);
+  void SubmitAsync();
+  // num_pages consecutive pages from first_page_id on in one read
+  void ReadPages(page_id_t first_page_id, char *data, size_t num_pages);
 
   void WriteLog(char *log_data, int size);
   bool ReadLog(char *log_data, int size, int offset);
@@ -31,19 +68,34 @@ public:
   page_id_t AllocatePage();
   void DeallocatePage(page_id_t page_id);
 
+  inline size_t GetPageSize() const { return page_size_; }
+  // pages the file holds, i.e. one past the last page id written
+  size_t GetNumPages() const;
+
   int GetNumFlushes() const;
+  int GetNumSyncs() const;
   bool GetFlushState() const;
   inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
 private:
   int GetFileSize(const std::string &name);
+  AsyncIO *GetAsyncIO();
+  void ReadFileHeader();
+  void WriteFileHeader();
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, for positional I/O only
+  int db_fd_;
+  // a page was written since the last fdatasync
+  std::atomic<bool> unsynced_;
+  std::atomic<int> num_syncs_;
+  // backend of the asynchronous page I/O, created by the first call
+  AsyncIO *async_io_ = nullptr;
+  std::once_flag async_io_once_;
   std::string file_name_;
+  size_t page_size_;
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
   bool flush_log_;
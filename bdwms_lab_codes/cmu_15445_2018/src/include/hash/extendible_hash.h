@@ -5,37 +5,90 @@
  * Functionality: The buffer pool manager must maintain a page table to be able
  * to quickly map a PageId to its corresponding memory location; or alternately
  * report that the PageId does not match any currently-buffered page.
+ *
+ * Buckets are flat: bucketSize key and value slots plus one byte per slot, the
+ * fingerprint (7 bits of the mixed hash, top bit set; 0 marks an empty slot).
+ * A lookup compares the fingerprint against FINGERPRINT_GROUP slots at once
+ * (SSE2, or AVX2 when the compiler targets it) and only compares the keys of
+ * the slots that match.
+ *
+ * Find takes no latch when K and V are trivially copyable. The directory is an
+ * array published through an atomic pointer: a split updates the entries in
+ * place, a doubling publishes a bigger copy and retires the old one through
+ * epochs. A bucket has a version that is odd while a writer changes it; the
+ * reader probes the bucket between two reads of the version and retries if
+ * it changed or the directory no longer points the key at that bucket.
+ * Writers latch the bucket, and a split also takes the directory latch.
+ *
+ * Remove merges a bucket into its buddy (the one that differs in the top
+ * local depth bit) once the two hold at most half a bucket together, so a
+ * merged bucket is not split again right away. The directory halves when it
+ * is two levels deeper than its deepest bucket, down to one level deeper.
+ * Merged away buckets and directories are retired through epochs.
+ *
+ * FindBatch and InsertBatch group the keys by bucket: a bucket is probed once
+ * per batch (one version check, or one latch), and the buckets and slots of
+ * the keys a few places ahead are prefetched while the current one is probed.
  */
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
 #include <string>
+#include <memory>
 #include <mutex>
-#include <map>
+#include <utility>
 
+#include "common/epoch_manager.h"
 #include "hash/hash_table.h"
 
 using namespace std;
 
 namespace cmudb {
 
+#if defined(__AVX2__)
+#define FINGERPRINT_GROUP 32 // slots whose fingerprints are compared at once
+#else
+#define FINGERPRINT_GROUP 16
+#endif
+
     template<typename K, typename V>
     class ExtendibleHash : public HashTable<K, V> {
         struct Bucket {
-            Bucket(int depth) : localDepth(depth) {};
+            Bucket(int depth, size_t capacity);
             int localDepth;
-            map<K, V> kmap;
+            size_t size;  // slots in use
+            atomic<uint64_t> version;  // odd while a writer changes the slots
+            // one per slot, padded to whole groups with empty ones
+            vector<uint8_t> fingerprints;
+            vector<K> keys;
+            vector<V> values;
             mutex latch;
         };
 
+        struct BatchKey {
+            Bucket *bucket;  // as the directory had it when grouped
+            size_t hash;
+            size_t index;  // of the key in the caller's vectors
+        };
+
+        struct Directory {
+            explicit Directory(int depth);
+            int globalDepth;
+            vector<atomic<Bucket *>> entries;  // 1 << globalDepth of them
+        };
+
     public:
         // constructor
         ExtendibleHash(size_t size);
 
         ExtendibleHash();
 
+        ~ExtendibleHash();
+
         // helper function to generate hash addressing
         size_t HashKey(const K &key) const;
 
@@ -46,6 +99,9 @@ namespace cmudb {
 
         int GetNumBuckets() const;
 
+        // bytes held by the directory and the buckets
+        size_t GetMemoryUsage() const;
+
         // lookup and modifier
         bool Find(const K &key, V &value) override;
 
@@ -53,14 +109,44 @@ namespace cmudb {
 
         void Insert(const K &key, const V &value) override;
 
+        size_t FindBatch(const vector<K> &keys, vector<V> &values,
+                         vector<bool> &found) override;
+
+        void InsertBatch(const vector<K> &keys,
+                         const vector<V> &values) override;
+
         int getIdx(const K &key) const;
 
     private:
+        static uint8_t Fingerprint(size_t hash);
+        // slot of key in bucket, -1 if it is not there
+        static int FindSlot(const Bucket &bucket, uint8_t fingerprint,
+                            const K &key);
+        // first empty slot of bucket, -1 if it is full
+        int FindEmptySlot(const Bucket &bucket) const;
+        // the bucket of key, latched, even while other threads split it
+        Bucket *LatchBucket(const K &key, unique_lock<mutex> &bucket_lock);
+        // bracket a change of the bucket's slots, under its latch
+        static void BeginWrite(Bucket &bucket);
+        static void EndWrite(Bucket &bucket);
+        // the keys of a batch with their hashes and the buckets the current
+        // directory points them at, keys of a bucket next to each other if
+        // that is likely to pay; call within an epoch
+        void GroupByBucket(const vector<K> &keys, vector<BatchKey> &batch);
+        static size_t GroupEnd(const vector<BatchKey> &batch, size_t begin);
+        static void PrefetchAhead(const vector<BatchKey> &batch, size_t k);
+        // merge the latched bucket of hash with its buddies while they are
+        // small enough, then shrink the directory if it can
+        void Merge(size_t hash, Bucket *cur, unique_lock<mutex> &bucket_lock);
+        void ShrinkDirectory();
+
         // add your own member variables here
-        int globalDepth;
         size_t bucketSize;
         int bucketNum;
-        vector<shared_ptr<Bucket>> directories;
-        mutable mutex latch;
+        atomic<Directory *> directory;
+        vector<unique_ptr<Bucket>> buckets;  // all of them, under latch
+        vector<int> bucketsAtDepth;  // bucket count per local depth, under latch
+        mutable mutex latch;  // held to change the directory
+        mutable EpochManager epochs;  // retired directories and buckets
     };
 } // namespace cmudb
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace cmudb {
 
 template <typename K, typename V> class HashTable {
@@ -16,6 +19,34 @@ public:
   virtual bool Find(const K &key, V &value) = 0;
   virtual bool Remove(const K &key) = 0;
   virtual void Insert(const K &key, const V &value) = 0;
+
+  // Find of every key: found[i] tells whether keys[i] is there and values[i]
+  // is its value then. Implementations may order the work to share locks and
+  // cache misses between keys
+  // @return: number of keys found
+  virtual size_t FindBatch(const std::vector<K> &keys, std::vector<V> &values,
+                           std::vector<bool> &found) {
+    values.assign(keys.size(), V());
+    found.assign(keys.size(), false);
+    size_t hits = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      V value;
+      if (Find(keys[i], value)) {
+        values[i] = value;
+        found[i] = true;
+        hits++;
+      }
+    }
+    return hits;
+  }
+
+  // Insert of every keys[i], values[i] pair, in order
+  virtual void InsertBatch(const std::vector<K> &keys,
+                           const std::vector<V> &values) {
+    for (size_t i = 0; i < keys.size(); i++) {
+      Insert(keys[i], values[i]);
+    }
+  }
 };
 
 } // namespace cmudb
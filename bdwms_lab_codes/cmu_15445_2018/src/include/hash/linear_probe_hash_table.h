@@ -0,0 +1,74 @@
+/*
+ * linear_probe_hash_table.h : concurrent open addressing hash table with
+ * linear probing
+ *
+ * Functionality: a page table for the buffer pool manager. Entries live in one
+ * flat array of slots sized from the expected number of entries (the pool
+ * capacity), so a lookup is a hash and a short scan over adjacent slots.
+ *
+ * Find never takes a lock. Insert and Remove are serialized by a mutex and
+ * bump a version counter around every change (a seqlock); Find reads the
+ * slots optimistically and retries if the version moved meanwhile. Remove
+ * shifts the following entries back instead of leaving tombstones, so probe
+ * sequences stay short however many pages come and go. FindBatch prefetches
+ * the home slots of the keys a few lookups ahead.
+ *
+ * K and V must be trivially copyable, they are stored in std::atomic.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+template <typename K, typename V>
+class LinearProbeHashTable : public HashTable<K, V> {
+  struct Slot {
+    std::atomic<bool> used{false};
+    std::atomic<K> key{K()};
+    std::atomic<V> value{V()};
+  };
+  struct Table {
+    explicit Table(size_t capacity)
+        : mask(capacity - 1), slots(new Slot[capacity]) {}
+    size_t mask; // capacity - 1, capacity is a power of two
+    std::unique_ptr<Slot[]> slots;
+  };
+
+public:
+  // room for expected_size entries at a load factor of at most 1/2
+  explicit LinearProbeHashTable(size_t expected_size);
+  ~LinearProbeHashTable();
+
+  // lookup and modifier
+  bool Find(const K &key, V &value) override;
+  bool Remove(const K &key) override;
+  void Insert(const K &key, const V &value) override;
+  size_t FindBatch(const std::vector<K> &keys, std::vector<V> &values,
+                   std::vector<bool> &found) override;
+
+  size_t GetSize();
+  size_t GetCapacity();
+
+private:
+  size_t HashKey(const K &key) const;
+  // caller holds write_latch_ inside a version window
+  void InsertInto(Table *table, const K &key, const V &value);
+  void Grow();
+
+  std::atomic<Table *> table_;
+  std::vector<Table *> retired_; // outgrown tables, readers may still look
+  size_t size_ = 0;              // number of entries, under write_latch_
+  std::atomic<uint64_t> version_{0}; // odd while a writer changes the table
+  std::mutex write_latch_;
+};
+
+} // namespace cmudb
@@ -25,10 +25,13 @@ namespace cmudb {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
  public:
+  // with retain_internal_pages, internal pages are kept resident (see
+  // BufferPoolManager::Retain) once they are visited
   explicit BPlusTree(const std::string &name,
                      BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator,
-                     page_id_t root_page_id = INVALID_PAGE_ID);
+                     page_id_t root_page_id = INVALID_PAGE_ID,
+                     bool retain_internal_pages = false);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -58,7 +61,7 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name,
                       Transaction *transaction = nullptr);
-  // expose for test purpose
+  // expose for test purpose, see the comment in b_plus_tree.cpp
   B_PLUS_TREE_LEAF_PAGE_TYPE *FindLeafPage(const KeyType &key,
                                            bool leftMost = false,
                                            OpType op = OpType::READ,
@@ -70,6 +73,8 @@ class BPlusTree {
  private:
   BPlusTreePage *FetchPage(page_id_t page_id);
 
+  ReadPageGuard FindLeafPageRead(const KeyType &key, bool leftMost = false);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value,
@@ -103,7 +108,7 @@ class BPlusTree {
 
   BPlusTreePage *CrabingProtocalFetchPage(page_id_t page_id, OpType op, page_id_t previous, Transaction *transaction);
 
-  void FreePageInTransaction(bool exclusive, Transaction *transaction, page_id_t cur = -1);
+  void FreePageInTransaction(bool exclusive, Transaction *transaction);
 
   inline void Lock(bool exclusive, Page *page) {
     if (exclusive) {
@@ -113,20 +118,6 @@ class BPlusTree {
     }
   }
 
-  inline void Unlock(bool exclusive, Page *page) {
-    if (exclusive) {
-      page->WUnlatch();
-    } else {
-      page->RUnlatch();
-    }
-  }
-
-  inline void Unlock(bool exclusive, page_id_t pageId){
-    auto page=buffer_pool_manager_->FetchPage(pageId);
-    Unlock(exclusive, page);
-    buffer_pool_manager_->UnpinPage(pageId, exclusive);  // remember to unpin the page because we fetch the page first
-  }
-
   inline void LockRootPageId(bool exclusive) {
     if (exclusive) {
       mutex_.WLock();
@@ -154,6 +145,7 @@ class BPlusTree {
   page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  bool retain_internal_pages_;
   RWMutex mutex_;
   static thread_local int rootLockedCnt;
 };
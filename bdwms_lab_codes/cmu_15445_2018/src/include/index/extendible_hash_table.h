@@ -0,0 +1,106 @@
+/**
+ * extendible_hash_table.h
+ *
+ * Disk based extendible hash table for equality lookups: a header page (see
+ * page/hash_table_header_page.h) picks one of up to 1 << header depth
+ * directory pages (see page/hash_table_directory_page.h) by the high bits of
+ * the hash, and that directory a bucket page (see
+ * page/hash_table_bucket_page.h) by the low bits. The header's slots never
+ * change once set and are cached here, so a lookup reads a directory and a
+ * bucket page whatever the size of the table.
+ * (1) We only support unique key
+ * (2) support insert & remove, a full bucket splits; buckets do not merge
+ * (3) a bucket at the directory's max depth chains overflow pages instead
+ *
+ * Latching: a directory page is always latched before a bucket page. Find,
+ * Remove and an Insert that fits read latch the directory just long enough to
+ * latch the bucket, so they only contend on the bucket. An Insert into a full
+ * bucket starts over with the directory write latched and splits; the other
+ * directories are not held up. The header page is write latched only to add
+ * a directory.
+ */
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "concurrency/transaction.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "page/hash_table_header_page.h"
+
+namespace cmudb {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE                                             \
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+public:
+  // a new table (header_page_id == INVALID_PAGE_ID) gets its hash table
+  // header page right away, recorded in the header page under name. It uses
+  // header_depth hash bits to pick a directory, and directory_max_depth bits
+  // at most within one; -1 takes as many as fit a page
+  explicit ExtendibleHashTable(const std::string &name,
+                               BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator,
+                               page_id_t header_page_id = INVALID_PAGE_ID,
+                               int header_depth = -1,
+                               int directory_max_depth = -1);
+
+  // Insert a key-value pair, false if the key is already there
+  bool Insert(const KeyType &key, const ValueType &value,
+              Transaction *transaction = nullptr);
+
+  // Remove a key and its value, false if it is not there
+  bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                Transaction *transaction = nullptr);
+
+  inline page_id_t GetHeaderPageId() const { return header_page_id_; }
+  // global depth of the directory that key goes to, -1 if it has none yet
+  int GetGlobalDepth(const KeyType &key);
+
+  // expose for test purpose: every key is in the directory and bucket its
+  // hash leads to and the local depths agree with the slots that share a
+  // bucket
+  bool Check();
+
+private:
+  using BucketPage = HASH_TABLE_BUCKET_PAGE_TYPE;
+  enum class InsertResult { INSERTED, DUPLICATE, FULL };
+
+  uint32_t HashKey(const KeyType &key) const;
+  Page *NewPage(page_id_t &page_id);
+  void InitHeader(int header_depth, int directory_max_depth);
+  uint32_t DirectoryIndex(uint32_t hash) const;
+  // the directory of a hash, INVALID_PAGE_ID if it has none and create is
+  // false
+  page_id_t GetDirectoryPageId(uint32_t hash, bool create);
+
+  // insert into the chain of the write latched bucket; with grow_chain a
+  // full chain gets another overflow page, otherwise it is FULL
+  InsertResult InsertIntoChain(WritePageGuard &bucket, const KeyType &key,
+                               const ValueType &value, bool grow_chain);
+
+  // split the full, write latched bucket of slot, doubling the directory if
+  // the bucket is as deep as it is
+  void SplitBucket(HashTableDirectoryPage *directory, uint32_t slot,
+                   WritePageGuard &bucket);
+
+  bool CheckDirectory(uint32_t index, page_id_t directory_page_id);
+
+  // member variable
+  std::string index_name_;
+  page_id_t header_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int header_depth_;
+  // the header page's slots, filled in as directories are found
+  std::vector<std::atomic<page_id_t>> directory_page_ids_;
+};
+
+} // namespace cmudb
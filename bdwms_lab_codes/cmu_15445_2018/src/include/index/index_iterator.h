@@ -14,8 +14,8 @@ INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
-  IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bufferPoolManager);
-  ~IndexIterator();
+  // guard holds the read latched leaf, or is empty for an empty tree
+  IndexIterator(ReadPageGuard &&guard, int index, BufferPoolManager *bufferPoolManager);
 
   bool isEnd() {
     return (leaf_ == nullptr);// || (index_ >= leaf_->GetSize());
@@ -29,15 +29,15 @@ class IndexIterator {
     index_++;
     if (index_ >= leaf_->GetSize()) {
       page_id_t next = leaf_->GetNextPageId();
-      UnlockAndUnPin();  // release read latch and then unpin the page
+      guard_.Release();  // release read latch and then unpin the page
       if (next == INVALID_PAGE_ID) {
         leaf_ = nullptr;
       } else {
-        //bufferPoolManager_->UnpinPage(leaf_->GetPageId(), false);
-        Page *page = bufferPoolManager_->FetchPage(next);
-        page->RLatch();  // remember to get the read latch
-        leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+        guard_ = bufferPoolManager_->FetchPageRead(next);
+        leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(guard_.GetPage()->GetData());
         index_ = 0;
+        // read the next leaf while the scan works through this one
+        bufferPoolManager_->Prefetch(leaf_->GetNextPageId(), 1);
       }
     }
     return *this;
@@ -45,12 +45,8 @@ class IndexIterator {
 
  private:
   // add your own private member variables here
-  void UnlockAndUnPin() {
-    bufferPoolManager_->FetchPage(leaf_->GetPageId())->RUnlatch();
-    bufferPoolManager_->UnpinPage(leaf_->GetPageId(), false);
-    bufferPoolManager_->UnpinPage(leaf_->GetPageId(), false);
-  }
   int index_;
+  ReadPageGuard guard_;  // latch and pin of the current leaf
   B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
   BufferPoolManager *bufferPoolManager_;
 };
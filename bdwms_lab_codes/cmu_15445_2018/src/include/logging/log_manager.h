@@ -20,10 +20,11 @@ class LogManager {
  public:
   LogManager(DiskManager *disk_manager)
       : needFlush_(false), next_lsn_(0), persistent_lsn_(INVALID_LSN),
+        log_buffer_size_(LOG_BUFFER_SIZE(disk_manager->GetPageSize())),
         disk_manager_(disk_manager) {
     // TODO: you may intialize your own defined memeber variables here
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    log_buffer_ = new char[log_buffer_size_];
+    flush_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogManager() {
@@ -62,6 +63,7 @@ class LogManager {
   // log records before & include persistent_lsn_ have been written to disk
   std::atomic<lsn_t> persistent_lsn_;
   // log buffer related
+  int32_t log_buffer_size_;
   char *log_buffer_;
   char *flush_buffer_;
   // latch to protect shared member variables
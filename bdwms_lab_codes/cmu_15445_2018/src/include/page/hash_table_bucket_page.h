@@ -0,0 +1,68 @@
+/**
+ * hash_table_bucket_page.h
+ *
+ * Bucket of a disk based extendible hash table: unordered key/value pairs.
+ * Only support unique key. A removed pair is replaced by the last one, so the
+ * pairs stay packed at the front.
+ *
+ * A bucket whose local depth is already the directory's max depth cannot
+ * split any more; it grows a chain of overflow pages through NextPageId.
+ *
+ * Bucket page format:
+ *  -----------------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  -----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 20 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | CurrentSize (4) | MaxSize (4) | NextPageId (4) |
+ *  ---------------------------------------------------------------------
+ */
+#pragma once
+
+#include <utility>
+
+#include "page/b_plus_tree_page.h" // INDEX_TEMPLATE_ARGUMENTS, MappingType
+
+namespace cmudb {
+#define HASH_TABLE_BUCKET_PAGE_TYPE                                            \
+  HashTableBucketPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class HashTableBucketPage {
+public:
+  // After creating a new bucket page from buffer pool, must call initialize
+  // method to set default values; page_size is the size of the page it lives
+  // in and decides the max size
+  void Init(page_id_t page_id, size_t page_size = PAGE_SIZE);
+
+  page_id_t GetPageId() const;
+  int GetSize() const;
+  int GetMaxSize() const;
+  bool IsFull() const;
+  // overflow page, INVALID_PAGE_ID at the end of the chain
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+
+  KeyType KeyAt(int index) const;
+  const MappingType &GetItem(int index) const;
+  // index of key, -1 if it is not in this page
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+
+  bool Lookup(const KeyType &key, ValueType &value,
+              const KeyComparator &comparator) const;
+  // append the pair, the caller checked that key is not there
+  // @return: false if the page is full
+  bool Insert(const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  page_id_t next_page_id_;
+  MappingType array_[0];
+};
+
+} // namespace cmudb
@@ -0,0 +1,66 @@
+/**
+ * hash_table_directory_page.h
+ *
+ * Directory of a disk based extendible hash table: the global depth, and for
+ * each of the 1 << global depth slots the page id of its bucket and that
+ * bucket's local depth. Slot i holds the bucket of the keys whose hash has i
+ * in its low global depth bits.
+ *
+ * The arrays are sized for 1 << MaxDepth slots, at most the largest power of
+ * two that fits the page, so the directory never moves to another page.
+ *
+ * Directory format (size in byte):
+ *  --------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | MaxDepth (4) | BucketPageIds  |
+ *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------
+ * | (4 * (1 << MaxDepth)) | LocalDepths (1 * (1 << MaxDepth)) |
+ *  --------------------------------------------------------
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class HashTableDirectoryPage {
+public:
+  // After creating a new directory page from buffer pool, must call
+  // initialize method to set default values: one slot, pointing at the first
+  // bucket. page_size is the size of the page it lives in and decides the
+  // max depth, unless max_depth caps it lower
+  void Init(page_id_t page_id, page_id_t bucket_page_id,
+            size_t page_size = PAGE_SIZE, int max_depth = -1);
+
+  page_id_t GetPageId() const;
+  int GetGlobalDepth() const;
+  int GetMaxDepth() const;
+  // 1 << global depth
+  uint32_t GetSize() const;
+  // the low global depth bits of a hash
+  uint32_t GetGlobalDepthMask() const;
+
+  page_id_t GetBucketPageId(uint32_t slot) const;
+  void SetBucketPageId(uint32_t slot, page_id_t bucket_page_id);
+  int GetLocalDepth(uint32_t slot) const;
+  void SetLocalDepth(uint32_t slot, int local_depth);
+
+  // double the slots, the new half a copy of the old one
+  // @return: false if the directory is at its max depth
+  bool IncrGlobalDepth();
+
+private:
+  uint8_t *LocalDepths();
+  const uint8_t *LocalDepths() const;
+
+  page_id_t page_id_;
+  lsn_t lsn_;
+  int global_depth_;
+  int max_depth_;
+  page_id_t bucket_page_ids_[0];
+};
+
+} // namespace cmudb
@@ -0,0 +1,55 @@
+/**
+ * hash_table_header_page.h
+ *
+ * First page of a disk based extendible hash table: the page ids of its
+ * directories (see page/hash_table_directory_page.h), chosen by the high
+ * Depth bits of a key's hash. Each directory is an extendible hash table of
+ * its own, created when the first key for it is inserted; a slot never
+ * changes once it is set.
+ *
+ * Header format (size in byte):
+ *  ---------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | Depth (4) | DirectoryMaxDepth (4) |
+ *  ---------------------------------------------------------------------
+ *  -------------------------------------------
+ * | DirectoryPageIds (4 * (1 << Depth)) |
+ *  -------------------------------------------
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class HashTableHeaderPage {
+public:
+  // After creating a new header page from buffer pool, must call initialize
+  // method to set default values: no directories yet. depth is the number of
+  // hash bits that choose a directory, and directory_max_depth caps the
+  // directories' global depth; -1 takes as many as fit the page
+  void Init(page_id_t page_id, size_t page_size = PAGE_SIZE, int depth = -1,
+            int directory_max_depth = -1);
+
+  page_id_t GetPageId() const;
+  int GetDepth() const;
+  int GetDirectoryMaxDepth() const;
+  // 1 << depth
+  uint32_t GetSize() const;
+  // the directory slot of a hash, from its high depth bits
+  uint32_t HashToDirectoryIndex(uint32_t hash) const;
+
+  page_id_t GetDirectoryPageId(uint32_t index) const;
+  void SetDirectoryPageId(uint32_t index, page_id_t directory_page_id);
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  int depth_;
+  int directory_max_depth_;
+  page_id_t directory_page_ids_[0];
+};
+
+} // namespace cmudb
@@ -3,7 +3,8 @@
  *
  * Database use the first page (page_id = 0) as header page to store metadata, in
  * our case, we will contain information about table/index name (length less than
- * 32 bytes) and their corresponding root_id
+ * 32 bytes) and their corresponding root_id. The number of records it can hold
+ * depends on the page size
  *
  * Format (size in byte):
  *  -----------------------------------------------------------------
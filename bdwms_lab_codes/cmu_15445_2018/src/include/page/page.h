@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -20,10 +21,12 @@ class Page {
   friend class BufferPoolManager;
 
 public:
-  Page() { ResetMemory(); }
+  Page() {}
   ~Page(){};
   // get actual data page content
   inline char *GetData() { return data_; }
+  // size of the page content, set by the database file
+  inline size_t GetPageSize() { return page_size_; }
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
   // get page pin count
@@ -39,12 +42,21 @@ public:
 
 private:
   // method used by buffer pool manager
-  inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, 0, page_size_); }
   // members
-  char data_[PAGE_SIZE]; // actual data
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  int pin_count_ = 0;
-  bool is_dirty_ = false;
+  char *data_ = nullptr; // actual data, page_size_ bytes owned by the buffer pool
+  size_t page_size_ = 0;
+  // page_id_, pin_count_ and is_dirty_ are atomic for the latch-free hit path
+  // of FetchPage; pin_count_ is -1 while the frame is claimed for eviction
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  std::atomic<int> pin_count_{0};
+  std::atomic<bool> is_dirty_{false};
+  std::atomic<bool> is_referenced_{false}; // hit since the last eviction scan
+  std::atomic<int64_t> access_stamp_{0}; // steady clock of the latest new reference
+  std::atomic<bool> is_flushing_{false}; // page cleaner is writing it back
+  std::atomic<bool> is_loading_{false};  // prefetch is reading it in
+  std::atomic<bool> is_retained_{false}; // holds a pin of the pool, see Retain
+  bool in_ring_ = false; // recycled by sequential access, not in the replacer
   RWMutex rwlatch_;
 };
 
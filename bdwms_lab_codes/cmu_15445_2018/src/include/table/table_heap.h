@@ -46,7 +46,9 @@ public:
 
   bool DeleteTableHeap();
 
-  TableIterator begin(Transaction *txn);
+  // full scan, see TableIterator for hint
+  TableIterator begin(Transaction *txn,
+                      AccessHint hint = AccessHint::SEQUENTIAL);
 
   TableIterator end();
 
@@ -8,6 +8,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_pool_manager.h"
 #include "common/rid.h"
 #include "table/tuple.h"
 
@@ -19,7 +20,10 @@ class TableIterator {
   friend class Cursor;
 
 public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  // pages are read with hint, by default through the buffer pool's ring for
+  // sequential access so that a scan does not evict the working set
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                AccessHint hint = AccessHint::SEQUENTIAL);
 
   ~TableIterator() { delete tuple_; }
 
@@ -43,6 +47,7 @@ private:
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  AccessHint hint_;
 };
 
 } // namespace cmudb
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "catalog/schema.h"
 #include "concurrency/transaction_manager.h"
 #include "index/b_plus_tree_index.h"
+#include "index/extendible_hash_index.h"
 #include "logging/log_manager.h"
 #include "sqlite/sqlite3ext.h"
 #include "table/table_heap.h"
@@ -62,17 +63,44 @@ int VtabBegin(sqlite3_vtab *pVTab);
 // storage engine
 class StorageEngine {
 public:
-  StorageEngine(std::string db_file_name) {
+  // page_size only applies to a new database file, an existing one keeps the
+  // page size it was created with. With warm_up the pages that were resident
+  // when the engine last ran are read back in before it is used, and the
+  // resident page list is saved from then on (db_file_name with ".warm").
+  // With index_pool_size > 0 index pages get a region of their own, of that
+  // many frames besides the pool_size frames for table pages
+  StorageEngine(std::string db_file_name, size_t page_size = PAGE_SIZE,
+                size_t pool_size = BUFFER_POOL_SIZE, bool warm_up = false,
+                size_t index_pool_size = 0) {
     ENABLE_LOGGING = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, page_size);
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ =
-        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (index_pool_size > 0) {
+      buffer_pool_manager_ = new BufferPoolManager(
+          std::vector<size_t>{pool_size, index_pool_size}, disk_manager_,
+          log_manager_, BUFFER_POOL_INSTANCES);
+    } else {
+      buffer_pool_manager_ =
+          new BufferPoolManager(pool_size, disk_manager_, log_manager_,
+                                BUFFER_POOL_INSTANCES);
+    }
+
+    if (warm_up) {
+      std::string warm_up_file =
+          db_file_name.substr(0, db_file_name.find(".")) + ".warm";
+      auto start = std::chrono::steady_clock::now();
+      size_t num_pages = buffer_pool_manager_->WarmUp(warm_up_file);
+      warm_up_time_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start);
+      LOG_INFO("warm-up read %zu pages in %lld ms", num_pages,
+               static_cast<long long>(warm_up_time_.count()));
+      buffer_pool_manager_->RunResidentPageSaver(warm_up_file);
+    }
 
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
@@ -82,8 +110,9 @@ public:
   ~StorageEngine() {
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
-    delete disk_manager_;
+    // the buffer pool's background threads still use the disk manager
     delete buffer_pool_manager_;
+    delete disk_manager_;
     delete log_manager_;
     delete lock_manager_;
     delete transaction_manager_;
@@ -94,6 +123,7 @@ public:
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
+  std::chrono::milliseconds warm_up_time_{0}; // time spent in WarmUp
 };
 
 StorageEngine *storage_engine_;
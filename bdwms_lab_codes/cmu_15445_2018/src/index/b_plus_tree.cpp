@@ -3,6 +3,7 @@
  */
 #include <iostream>
 #include <string>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -16,9 +17,10 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(const std::string &name,
                           BufferPoolManager *buffer_pool_manager,
                           const KeyComparator &comparator,
-                          page_id_t root_page_id)
+                          page_id_t root_page_id, bool retain_internal_pages)
     : index_name_(name), root_page_id_(root_page_id),
-      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {}
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      retain_internal_pages_(retain_internal_pages) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -40,18 +42,13 @@ INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
                               std::vector<ValueType> &result,
                               Transaction *transaction) {
-  B_PLUS_TREE_LEAF_PAGE_TYPE
-      *targetPage = FindLeafPage(key, false, OpType::READ, transaction);  // find the page containing the key
-  if (targetPage == nullptr) {
+  ReadPageGuard guard = FindLeafPageRead(key);  // find the page containing the key
+  if (!guard) {
     return false;
   }
+  auto targetPage = guard.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
   result.resize(1);
-  auto isFind = targetPage->Lookup(key, result[0], comparator_);  // put the value in the result
-
-  //buffer_pool_manager_->UnpinPage(targetPage->GetPageId(), false);  // unpin this page
-  FreePageInTransaction(false, transaction, targetPage->GetPageId());
-  //assert(buffer_pool_manager_->CheckAllUnpined());
-  return isFind;
+  return targetPage->Lookup(key, result[0], comparator_);  // put the value in the result
 }
 
 /*****************************************************************************
@@ -93,7 +90,7 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   // convert the struct Page into the struct B_PLUS_TREE_LEAF_PAGE_TYPE
   B_PLUS_TREE_LEAF_PAGE_TYPE *root = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(rootPage->GetData());
 
-  root->Init(newRootPageId, INVALID_PAGE_ID); // init the root
+  root->Init(newRootPageId, INVALID_PAGE_ID, rootPage->GetPageSize()); // init the root
   root_page_id_ = newRootPageId;
   UpdateRootPageId(true);  // insert a new root page id into header page
   root->Insert(key, value, comparator_); // insert key/value into leaf page
@@ -153,7 +150,7 @@ N *BPLUSTREE_TYPE::Split(N *node, Transaction *transaction) {
   N *newNode = reinterpret_cast<N *>(newPage->GetData());
 
   // init the new node(leaf or internal page)
-  newNode->Init(newPageId, node->GetParentPageId());
+  newNode->Init(newPageId, node->GetParentPageId(), newPage->GetPageSize());
   // move half key/value into new node
   node->MoveHalfTo(newNode, buffer_pool_manager_);
   return newNode;
@@ -179,7 +176,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
     assert(newPage != nullptr);
     assert(newPage->GetPinCount() == 1);
     B_PLUS_TREE_INTERNAL_PAGE *newRoot = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(newPage->GetData());
-    newRoot->Init(root_page_id_);
+    newRoot->Init(root_page_id_, INVALID_PAGE_ID, newPage->GetPageSize());
     newRoot->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
     old_node->SetParentPageId(root_page_id_);
     new_node->SetParentPageId(root_page_id_);
@@ -399,9 +396,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
   KeyType useless;
-  auto start_leaf = FindLeafPage(useless, true);
-  TryUnlockRootPageId(false);
-  return INDEXITERATOR_TYPE(start_leaf, 0, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(FindLeafPageRead(useless, true), 0, buffer_pool_manager_);
 }
 
 /*
@@ -411,13 +406,12 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  auto start_leaf = FindLeafPage(key);
-  TryUnlockRootPageId(false);
-  if (start_leaf == nullptr) {
-    return INDEXITERATOR_TYPE(start_leaf, 0, buffer_pool_manager_);
+  ReadPageGuard guard = FindLeafPageRead(key);
+  int idx = 0;
+  if (guard) {
+    idx = guard.As<B_PLUS_TREE_LEAF_PAGE_TYPE>()->KeyIndex(key, comparator_);
   }
-  int idx = start_leaf->KeyIndex(key, comparator_);
-  return INDEXITERATOR_TYPE(start_leaf, idx, buffer_pool_manager_);
+  return INDEXITERATOR_TYPE(std::move(guard), idx, buffer_pool_manager_);
 }
 
 /*****************************************************************************
@@ -426,10 +420,13 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * The pages on the path stay latched and pinned in the transaction's page set
+ * until FreePageInTransaction, so the transaction is required
  */
 INDEX_TEMPLATE_ARGUMENTS
 B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
                                                          bool leftMost, OpType op, Transaction *transaction) {
+  assert(transaction != nullptr);
   bool exclusive = (op != OpType::READ);
   LockRootPageId(exclusive);
   if (IsEmpty()) {
@@ -451,6 +448,37 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key,
   return static_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(pointer);
 }
 
+/*
+ * Read only descent to the leaf containing key (or the left most leaf), for
+ * searches and iterators. Latches are coupled hand over hand with page guards
+ * and the returned guard holds the read latched leaf, empty if the tree is
+ * empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ReadPageGuard BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool leftMost) {
+  LockRootPageId(false);
+  if (IsEmpty()) {
+    TryUnlockRootPageId(false);
+    return ReadPageGuard();
+  }
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+  assert(guard);
+  auto node = guard.As<BPlusTreePage>();
+  while (!node->IsLeafPage()) {
+    if (retain_internal_pages_) {
+      buffer_pool_manager_->Retain(guard.GetPage());
+    }
+    auto internalPage = reinterpret_cast<const B_PLUS_TREE_INTERNAL_PAGE *>(node);
+    page_id_t next = leftMost ? internalPage->ValueAt(0) : internalPage->Lookup(key, comparator_);
+    guard = buffer_pool_manager_->FetchPageRead(next);  // latch the child, then release the parent
+    assert(guard);
+    TryUnlockRootPageId(false);
+    node = guard.As<BPlusTreePage>();
+  }
+  TryUnlockRootPageId(false);
+  return guard;
+}
+
 /*
  * Fetch the page from the buffer pool manager using its unique page_id, then reinterpret cast to either
  * a leaf or an internal page
@@ -473,6 +501,9 @@ BPlusTreePage *BPLUSTREE_TYPE::CrabingProtocalFetchPage(page_id_t page_id,
   auto page = buffer_pool_manager_->FetchPage(page_id);
   Lock(exclusive, page);
   auto treePage = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (retain_internal_pages_ && !treePage->IsLeafPage()) {
+    buffer_pool_manager_->Retain(page);
+  }
   /*
    * in here, we use basic crabbing protocol
    * Search: Start at root and go down, repeatedly acquire latch on child and then unlatch parent.
@@ -480,7 +511,7 @@ BPlusTreePage *BPLUSTREE_TYPE::CrabingProtocalFetchPage(page_id_t page_id,
    * if it is safe. If the child is safe, release latches on all its ancestors.
    */
   if (previous > 0 && (!exclusive || treePage->IsSafe(op))) {
-    FreePageInTransaction(exclusive, transaction, previous);
+    FreePageInTransaction(exclusive, transaction);
   }
   if (transaction != nullptr) {
     transaction->AddIntoPageSet(page);
@@ -489,23 +520,21 @@ BPlusTreePage *BPLUSTREE_TYPE::CrabingProtocalFetchPage(page_id_t page_id,
 }
 
 /*
- * 1.unlock the page in read operation
+ * 1.unlock and unpin the pages latched by the transaction
  * 2.delete the page in the delete set
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::FreePageInTransaction(bool exclusive, Transaction *transaction, page_id_t cur) {
+void BPLUSTREE_TYPE::FreePageInTransaction(bool exclusive, Transaction *transaction) {
   TryUnlockRootPageId(exclusive);
-  if (transaction == nullptr) {
-    assert(!exclusive && cur >= 0);  // make sure it's READ
-    Unlock(false, cur);
-    buffer_pool_manager_->UnpinPage(cur, false);
-    return;
-  }
   // delete the page stored in the transaction delete set (we delete the page together in here)
   for (Page *page : *transaction->GetPageSet()) {
     int curPid = page->GetPageId();
-    Unlock(exclusive, page);
-    buffer_pool_manager_->UnpinPage(curPid, exclusive);
+    // hand the latch and pin to a guard, which releases the frame directly
+    if (exclusive) {
+      WritePageGuard(buffer_pool_manager_, page).Release();
+    } else {
+      ReadPageGuard(buffer_pool_manager_, page).Release();
+    }
     if (transaction->GetDeletedPageSet()->find(curPid) != transaction->GetDeletedPageSet()->end()) {
       buffer_pool_manager_->DeletePage(curPid);
       transaction->GetDeletedPageSet()->erase(curPid);
@@ -547,12 +576,12 @@ std::string BPLUSTREE_TYPE::ToString(bool verbose) {
   }
   std::queue<BPlusTreePage *> todo, tmp;
   std::stringstream tree;
-  auto node = reinterpret_cast<BPlusTreePage *>(
-      buffer_pool_manager_->FetchPage(root_page_id_));
-  if (node == nullptr) {
+  auto root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (root_page == nullptr) {
     throw Exception(EXCEPTION_TYPE_INDEX,
                     "all page are pinned while printing");
   }
+  auto node = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
   todo.push(node);
   bool first = true;
   while (!todo.empty()) {
@@ -624,10 +653,11 @@ void BPLUSTREE_TYPE::RemoveFromFile(const std::string &file_name,
 INDEX_TEMPLATE_ARGUMENTS
 int BPLUSTREE_TYPE::isBalanced(page_id_t pid) {
   if (IsEmpty()) return true;
-  auto node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(pid));
-  if (node == nullptr) {
+  auto raw_page = buffer_pool_manager_->FetchPage(pid);
+  if (raw_page == nullptr) {
     throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while isBalanced");
   }
+  auto node = reinterpret_cast<BPlusTreePage *>(raw_page->GetData());
   int ret = 0;
   if (!node->IsLeafPage()) {
     auto page = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(node);
@@ -650,10 +680,11 @@ int BPLUSTREE_TYPE::isBalanced(page_id_t pid) {
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::isPageCorr(page_id_t pid, pair<KeyType, KeyType> &out) {
   if (IsEmpty()) return true;
-  auto node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(pid));
-  if (node == nullptr) {
+  auto raw_page = buffer_pool_manager_->FetchPage(pid);
+  if (raw_page == nullptr) {
     throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while isPageCorr");
   }
+  auto node = reinterpret_cast<BPlusTreePage *>(raw_page->GetData());
   bool ret = true;
   if (node->IsLeafPage()) {
     auto page = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(node);
@@ -0,0 +1,469 @@
+/**
+ * extendible_hash_table.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/extendible_hash_table.h"
+#include "page/header_page.h"
+
+namespace cmudb {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(
+    const std::string &name, BufferPoolManager *buffer_pool_manager,
+    const KeyComparator &comparator, page_id_t header_page_id,
+    int header_depth, int directory_max_depth)
+    : index_name_(name), header_page_id_(header_page_id),
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    InitHeader(header_depth, directory_max_depth);
+  }
+  ReadPageGuard header_guard =
+      buffer_pool_manager_->FetchPageRead(header_page_id_);
+  auto header = header_guard.As<HashTableHeaderPage>();
+  header_depth_ = header->GetDepth();
+  directory_page_ids_ =
+      std::vector<std::atomic<page_id_t>>(header->GetSize());
+  for (uint32_t i = 0; i < header->GetSize(); i++) {
+    directory_page_ids_[i].store(header->GetDirectoryPageId(i));
+  }
+}
+
+/*
+ * FNV-1a over the key bytes, then mixed so that the low bits the directory
+ * uses depend on all of them
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::HashKey(const KeyType &key) const {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&key);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < sizeof(KeyType); i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return static_cast<uint32_t>(hash);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *EXTENDIBLE_HASH_TABLE_TYPE::NewPage(page_id_t &page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory");
+  }
+  return page;
+}
+
+/*
+ * hash table header without directories, recorded in the header page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::InitHeader(int header_depth,
+                                            int directory_max_depth) {
+  Page *page = NewPage(header_page_id_);
+  reinterpret_cast<HashTableHeaderPage *>(page->GetData())
+      ->Init(header_page_id_, page->GetPageSize(), header_depth,
+             directory_max_depth);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->InsertRecord(index_name_, header_page_id_);
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::DirectoryIndex(uint32_t hash) const {
+  // a 32 bit shift is undefined
+  return header_depth_ == 0 ? 0 : hash >> (32 - header_depth_);
+}
+
+/*
+ * A cached slot is final. A missing one is looked up in the header page, it
+ * may have been added through another instance; with create, the header is
+ * write latched to add a directory with one empty bucket
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t EXTENDIBLE_HASH_TABLE_TYPE::GetDirectoryPageId(uint32_t hash,
+                                                         bool create) {
+  uint32_t index = DirectoryIndex(hash);
+  page_id_t directory_page_id = directory_page_ids_[index].load();
+  if (directory_page_id != INVALID_PAGE_ID) {
+    return directory_page_id;
+  }
+  if (!create) {
+    ReadPageGuard header_guard =
+        buffer_pool_manager_->FetchPageRead(header_page_id_);
+    directory_page_id =
+        header_guard.As<HashTableHeaderPage>()->GetDirectoryPageId(index);
+  } else {
+    WritePageGuard header_guard =
+        buffer_pool_manager_->FetchPageWrite(header_page_id_);
+    auto header = header_guard.As<HashTableHeaderPage>();
+    directory_page_id = header->GetDirectoryPageId(index);
+    if (directory_page_id == INVALID_PAGE_ID) {
+      page_id_t bucket_page_id;
+      Page *bucket_page = NewPage(bucket_page_id);
+      reinterpret_cast<BucketPage *>(bucket_page->GetData())
+          ->Init(bucket_page_id, bucket_page->GetPageSize());
+      Page *directory_page = NewPage(directory_page_id);
+      reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData())
+          ->Init(directory_page_id, bucket_page_id,
+                 directory_page->GetPageSize(),
+                 header->GetDirectoryMaxDepth());
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      buffer_pool_manager_->UnpinPage(directory_page_id, true);
+      header->SetDirectoryPageId(index, directory_page_id);
+    } else {
+      header_guard.SetDirty(false);
+    }
+  }
+  if (directory_page_id != INVALID_PAGE_ID) {
+    directory_page_ids_[index].store(directory_page_id);
+  }
+  return directory_page_id;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key
+ * The bucket is latched before the directory is released, so a split cannot
+ * move the key away in between
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(const KeyType &key,
+                                          std::vector<ValueType> &result,
+                                          Transaction *transaction) {
+  uint32_t hash = HashKey(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  ReadPageGuard directory_guard =
+      buffer_pool_manager_->FetchPageRead(directory_page_id);
+  auto directory = directory_guard.As<HashTableDirectoryPage>();
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(
+      directory->GetBucketPageId(hash & directory->GetGlobalDepthMask()));
+  directory_guard.Release();
+
+  while (true) {
+    auto bucket = guard.As<BucketPage>();
+    ValueType value;
+    if (bucket->Lookup(key, value, comparator_)) {
+      result.push_back(value);
+      return true;
+    }
+    page_id_t next = bucket->GetNextPageId();
+    if (next == INVALID_PAGE_ID) {
+      return false;
+    }
+    guard = buffer_pool_manager_->FetchPageRead(next); // latch the next page, then release this one
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth(const KeyType &key) {
+  page_id_t directory_page_id = GetDirectoryPageId(HashKey(key), false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return -1;
+  }
+  ReadPageGuard directory_guard =
+      buffer_pool_manager_->FetchPageRead(directory_page_id);
+  return directory_guard.As<HashTableDirectoryPage>()->GetGlobalDepth();
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the bucket of key. The directory is
+ * read latched unless the bucket is full; then it is write latched and the
+ * bucket split (until the key fits, or the bucket is at max depth and grows
+ * an overflow page)
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(const KeyType &key,
+                                        const ValueType &value,
+                                        Transaction *transaction) {
+  uint32_t hash = HashKey(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash, true);
+  {
+    ReadPageGuard directory_guard =
+        buffer_pool_manager_->FetchPageRead(directory_page_id);
+    auto directory = directory_guard.As<HashTableDirectoryPage>();
+    uint32_t slot = hash & directory->GetGlobalDepthMask();
+    bool at_max_depth =
+        directory->GetLocalDepth(slot) == directory->GetMaxDepth();
+    WritePageGuard bucket =
+        buffer_pool_manager_->FetchPageWrite(directory->GetBucketPageId(slot));
+    directory_guard.Release();
+    InsertResult result = InsertIntoChain(bucket, key, value, at_max_depth);
+    if (result != InsertResult::FULL) {
+      return result == InsertResult::INSERTED;
+    }
+  }
+
+  WritePageGuard directory_guard =
+      buffer_pool_manager_->FetchPageWrite(directory_page_id);
+  auto directory = directory_guard.As<HashTableDirectoryPage>();
+  directory_guard.SetDirty(false);
+  while (true) {
+    uint32_t slot = hash & directory->GetGlobalDepthMask();
+    WritePageGuard bucket =
+        buffer_pool_manager_->FetchPageWrite(directory->GetBucketPageId(slot));
+    InsertResult result = InsertIntoChain(
+        bucket, key, value,
+        directory->GetLocalDepth(slot) == directory->GetMaxDepth());
+    if (result != InsertResult::FULL) {
+      return result == InsertResult::INSERTED;
+    }
+    SplitBucket(directory, slot, bucket);
+    directory_guard.SetDirty(true);
+  }
+}
+
+/*
+ * The bucket's write latch keeps other writers out of its whole chain; the
+ * overflow pages are write latched too, for readers that are further down
+ * the chain
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename EXTENDIBLE_HASH_TABLE_TYPE::InsertResult
+EXTENDIBLE_HASH_TABLE_TYPE::InsertIntoChain(WritePageGuard &bucket,
+                                            const KeyType &key,
+                                            const ValueType &value,
+                                            bool grow_chain) {
+  // the key may be anywhere in the chain
+  page_id_t room = INVALID_PAGE_ID; // first page with a free slot
+  page_id_t last = bucket.GetPageId();
+  auto page = bucket.As<BucketPage>();
+  WritePageGuard overflow;
+  while (true) {
+    if (page->KeyIndex(key, comparator_) >= 0) {
+      bucket.SetDirty(false);
+      return InsertResult::DUPLICATE;
+    }
+    if (room == INVALID_PAGE_ID && !page->IsFull()) {
+      room = last;
+    }
+    if (page->GetNextPageId() == INVALID_PAGE_ID) {
+      break;
+    }
+    overflow = buffer_pool_manager_->FetchPageWrite(page->GetNextPageId());
+    overflow.SetDirty(false);
+    last = overflow.GetPageId();
+    page = overflow.As<BucketPage>();
+  }
+
+  if (room == bucket.GetPageId()) {
+    bucket.As<BucketPage>()->Insert(key, value);
+    return InsertResult::INSERTED;
+  }
+  bucket.SetDirty(false);
+  if (room != INVALID_PAGE_ID) {
+    if (room != last) {
+      // back up the chain, only the bucket's latch is held meanwhile
+      overflow.Release();
+      overflow = buffer_pool_manager_->FetchPageWrite(room);
+    }
+    overflow.SetDirty(true);
+    overflow.As<BucketPage>()->Insert(key, value);
+    return InsertResult::INSERTED;
+  }
+  if (!grow_chain) {
+    return InsertResult::FULL;
+  }
+  // append an overflow page to the last one
+  page_id_t new_page_id;
+  Page *new_page = NewPage(new_page_id);
+  auto new_bucket = reinterpret_cast<BucketPage *>(new_page->GetData());
+  new_bucket->Init(new_page_id, new_page->GetPageSize());
+  new_bucket->Insert(key, value);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  if (overflow) {
+    overflow.SetDirty(true);
+  } else {
+    bucket.SetDirty(true);
+  }
+  page->SetNextPageId(new_page_id);
+  return InsertResult::INSERTED;
+}
+
+/*
+ * The keys whose hash has the next bit set move to a new bucket, and so do
+ * the directory slots with that bit. The caller holds the directory write
+ * latch, nobody else can reach the new bucket before it is released
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *directory,
+                                             uint32_t slot,
+                                             WritePageGuard &bucket) {
+  int local_depth = directory->GetLocalDepth(slot);
+  assert(local_depth < directory->GetMaxDepth());
+  if (local_depth == directory->GetGlobalDepth()) {
+    directory->IncrGlobalDepth();
+  }
+  page_id_t old_page_id = bucket.GetPageId();
+  page_id_t new_page_id;
+  Page *new_page = NewPage(new_page_id);
+  auto new_bucket = reinterpret_cast<BucketPage *>(new_page->GetData());
+  new_bucket->Init(new_page_id, new_page->GetPageSize());
+
+  uint32_t high_bit = 1u << local_depth;
+  auto old_bucket = bucket.As<BucketPage>();
+  bucket.SetDirty(true);
+  // backwards, the pair that fills a hole has been looked at already
+  for (int i = old_bucket->GetSize() - 1; i >= 0; i--) {
+    const MappingType &item = old_bucket->GetItem(i);
+    if (HashKey(item.first) & high_bit) {
+      new_bucket->Insert(item.first, item.second);
+      old_bucket->RemoveAt(i);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+  for (uint32_t i = 0; i < directory->GetSize(); i++) {
+    if (directory->GetBucketPageId(i) == old_page_id) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if (i & high_bit) {
+        directory->SetBucketPageId(i, new_page_id);
+      }
+    }
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key
+ * An overflow page that becomes empty is unlinked and deleted; buckets are
+ * never merged
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(const KeyType &key,
+                                        Transaction *transaction) {
+  uint32_t hash = HashKey(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  ReadPageGuard directory_guard =
+      buffer_pool_manager_->FetchPageRead(directory_page_id);
+  auto directory = directory_guard.As<HashTableDirectoryPage>();
+  WritePageGuard bucket = buffer_pool_manager_->FetchPageWrite(
+      directory->GetBucketPageId(hash & directory->GetGlobalDepthMask()));
+  directory_guard.Release();
+
+  auto page = bucket.As<BucketPage>();
+  int index = page->KeyIndex(key, comparator_);
+  if (index >= 0) {
+    page->RemoveAt(index);
+    return true;
+  }
+  bucket.SetDirty(false);
+  // the overflow pages, the one before stays latched to unlink an empty one
+  WritePageGuard previous;
+  page_id_t next = page->GetNextPageId();
+  while (next != INVALID_PAGE_ID) {
+    WritePageGuard current = buffer_pool_manager_->FetchPageWrite(next);
+    auto overflow = current.As<BucketPage>();
+    index = overflow->KeyIndex(key, comparator_);
+    if (index >= 0) {
+      overflow->RemoveAt(index);
+      if (overflow->GetSize() == 0) {
+        WritePageGuard &before = previous ? previous : bucket;
+        before.As<BucketPage>()->SetNextPageId(overflow->GetNextPageId());
+        before.SetDirty(true);
+        current.Release();
+        buffer_pool_manager_->DeletePage(next);
+      }
+      return true;
+    }
+    current.SetDirty(false);
+    next = overflow->GetNextPageId();
+    previous = std::move(current);
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Check() {
+  for (uint32_t index = 0; index < directory_page_ids_.size(); index++) {
+    // the first hash of the directory's range
+    uint32_t first_hash = header_depth_ == 0 ? 0 : index << (32 - header_depth_);
+    page_id_t directory_page_id = GetDirectoryPageId(first_hash, false);
+    if (directory_page_id != INVALID_PAGE_ID &&
+        !CheckDirectory(index, directory_page_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::CheckDirectory(uint32_t index,
+                                                page_id_t directory_page_id) {
+  ReadPageGuard directory_guard =
+      buffer_pool_manager_->FetchPageRead(directory_page_id);
+  auto directory = directory_guard.As<HashTableDirectoryPage>();
+  int global_depth = directory->GetGlobalDepth();
+  for (uint32_t slot = 0; slot < directory->GetSize(); slot++) {
+    int local_depth = directory->GetLocalDepth(slot);
+    if (local_depth > global_depth) {
+      return false;
+    }
+    uint32_t local_mask = (1u << local_depth) - 1;
+    page_id_t bucket_page_id = directory->GetBucketPageId(slot);
+    // the slots that share the bucket are the ones that agree in the low
+    // local depth bits
+    for (uint32_t i = 0; i < directory->GetSize(); i++) {
+      bool same_bucket = directory->GetBucketPageId(i) == bucket_page_id;
+      if (same_bucket != ((i & local_mask) == (slot & local_mask)) ||
+          (same_bucket && directory->GetLocalDepth(i) != local_depth)) {
+        return false;
+      }
+    }
+    if ((slot & local_mask) != slot) {
+      continue; // checked the bucket's keys for the first of its slots
+    }
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+    while (true) {
+      auto bucket = guard.As<BucketPage>();
+      for (int i = 0; i < bucket->GetSize(); i++) {
+        uint32_t hash = HashKey(bucket->KeyAt(i));
+        if ((hash & local_mask) != slot || DirectoryIndex(hash) != index) {
+          return false;
+        }
+      }
+      if (bucket->GetNextPageId() == INVALID_PAGE_ID) {
+        break;
+      }
+      if (local_depth != directory->GetMaxDepth()) {
+        return false; // only buckets that cannot split overflow
+      }
+      guard = buffer_pool_manager_->FetchPageRead(bucket->GetNextPageId());
+    }
+  }
+  return true;
+}
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace cmudb
@@ -2,6 +2,7 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
 #include "index/index_iterator.h"
 
@@ -12,13 +13,11 @@ namespace cmudb {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bufferPoolManager)
-    : index_(index), leaf_(leaf), bufferPoolManager_(bufferPoolManager) {}
-
-INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
-  if (leaf_ != nullptr) {
-    UnlockAndUnPin();  // remember to release the read latch first
+INDEXITERATOR_TYPE::IndexIterator(ReadPageGuard &&guard, int index, BufferPoolManager *bufferPoolManager)
+    : index_(index), guard_(std::move(guard)), leaf_(nullptr), bufferPoolManager_(bufferPoolManager) {
+  if (guard_) {
+    leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(guard_.GetPage()->GetData());
+    bufferPoolManager_->Prefetch(leaf_->GetNextPageId(), 1);
   }
 }
 
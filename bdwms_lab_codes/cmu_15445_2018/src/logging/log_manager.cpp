@@ -75,10 +75,10 @@ void LogManager::StopFlushThread() {
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
   unique_lock<mutex> latch(latch_);
   // if the log buffer will be full, wake up the flush thread, and wait this thread until the log buffer is enough to record
-  if (logBufferOffset_ + log_record.GetSize() >= LOG_BUFFER_SIZE) {
+  if (logBufferOffset_ + log_record.GetSize() >= log_buffer_size_) {
     needFlush_ = true;
     cv_.notify_one();
-    appendCv_.wait(latch, [&] { return logBufferOffset_ + log_record.GetSize() < LOG_BUFFER_SIZE; });
+    appendCv_.wait(latch, [&] { return logBufferOffset_ + log_record.GetSize() < log_buffer_size_; });
   }
   log_record.lsn_ = next_lsn_++; // update the lsn
   // copy the log header first
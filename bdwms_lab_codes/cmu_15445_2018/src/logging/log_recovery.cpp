@@ -14,13 +14,13 @@ namespace cmudb {
 bool LogRecovery::DeserializeLogRecord(const char *data,
                                        LogRecord &log_record) {
   // left size should be larger than header size
-  if (data + LogRecord::HEADER_SIZE > log_buffer_ + LOG_BUFFER_SIZE) {
+  if (data + LogRecord::HEADER_SIZE > log_buffer_ + log_buffer_size_) {
     return false;
   }
   // first copy the header to log_record to judge the log type
   memcpy(&log_record, data, LogRecord::HEADER_SIZE);
   // make sure the size of log_record that has deserialized < log buffer size
-  if (log_record.size_ <= 0 || data + log_record.size_ > log_buffer_ + LOG_BUFFER_SIZE) {
+  if (log_record.size_ <= 0 || data + log_record.size_ > log_buffer_ + log_buffer_size_) {
     return false;
   }
   // jump to the data position
@@ -64,10 +64,10 @@ void LogRecovery::Redo() {
   int bufferOffset = 0;
   // read the log to the log_buffer_ + bufferOffset position
   while (disk_manager_->ReadLog(log_buffer_ + bufferOffset,
-                                LOG_BUFFER_SIZE - bufferOffset,
+                                log_buffer_size_ - bufferOffset,
                                 offset_)) {// false means log eof
     int bufferStart = offset_;
-    offset_ += LOG_BUFFER_SIZE - bufferOffset;
+    offset_ += log_buffer_size_ - bufferOffset;
     bufferOffset = 0;
     LogRecord log;
     //
@@ -88,7 +88,7 @@ void LogRecovery::Redo() {
         // so we need redo this action.
         bool needRedo = log.lsn_ > page->GetLSN();
         if (needRedo) {
-          page->Init(log.page_id_, PAGE_SIZE, log.prev_page_id_, nullptr, nullptr);
+          page->Init(log.page_id_, page->GetPageSize(), log.prev_page_id_, nullptr, nullptr);
           page->SetLSN(log.lsn_);
           if (log.prev_page_id_ != INVALID_PAGE_ID) {
             auto prevPage = static_cast<TablePage *>(
@@ -129,8 +129,8 @@ void LogRecovery::Redo() {
       }
       buffer_pool_manager_->UnpinPage(page->GetPageId(), needRedo);
     }
-    memmove(log_buffer_, log_buffer_ + bufferOffset, LOG_BUFFER_SIZE - bufferOffset);
-    bufferOffset = LOG_BUFFER_SIZE - bufferOffset;//rest partial log
+    memmove(log_buffer_, log_buffer_ + bufferOffset, log_buffer_size_ - bufferOffset);
+    bufferOffset = log_buffer_size_ - bufferOffset;//rest partial log
   }
 }
 
@@ -148,7 +148,7 @@ void LogRecovery::Undo() {
     lsn_t lsn = txn.second;
     while (lsn != INVALID_LSN) {
       LogRecord log;
-      disk_manager_->ReadLog(log_buffer_, PAGE_SIZE, lsn_mapping_[lsn]);
+      disk_manager_->ReadLog(log_buffer_, disk_manager_->GetPageSize(), lsn_mapping_[lsn]);
       assert(DeserializeLogRecord(log_buffer_, log));
       assert(log.lsn_ == lsn);
       lsn = log.prev_lsn_;  // continue for next lsn
@@ -0,0 +1,86 @@
+/**
+ * hash_table_directory_page.cpp
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "page/hash_table_directory_page.h"
+
+namespace cmudb {
+
+/*
+ * Init method after creating a new directory page
+ * A slot takes a page id and a local depth byte
+ */
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id,
+                                  size_t page_size, int max_depth) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  global_depth_ = 0;
+  size_t slots = (page_size - sizeof(HashTableDirectoryPage)) /
+                 (sizeof(page_id_t) + sizeof(uint8_t));
+  max_depth_ = 0;
+  while ((static_cast<size_t>(2) << max_depth_) <= slots) {
+    max_depth_++;
+  }
+  if (max_depth >= 0 && max_depth < max_depth_) {
+    max_depth_ = max_depth;
+  }
+  bucket_page_ids_[0] = bucket_page_id;
+  LocalDepths()[0] = 0;
+}
+
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+int HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+int HashTableDirectoryPage::GetMaxDepth() const { return max_depth_; }
+uint32_t HashTableDirectoryPage::GetSize() const { return 1u << global_depth_; }
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const {
+  return GetSize() - 1;
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t slot) const {
+  assert(slot < GetSize());
+  return bucket_page_ids_[slot];
+}
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t slot,
+                                             page_id_t bucket_page_id) {
+  assert(slot < GetSize());
+  bucket_page_ids_[slot] = bucket_page_id;
+}
+
+int HashTableDirectoryPage::GetLocalDepth(uint32_t slot) const {
+  assert(slot < GetSize());
+  return LocalDepths()[slot];
+}
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t slot, int local_depth) {
+  assert(slot < GetSize() && local_depth <= global_depth_);
+  LocalDepths()[slot] = static_cast<uint8_t>(local_depth);
+}
+
+bool HashTableDirectoryPage::IncrGlobalDepth() {
+  if (global_depth_ == max_depth_) {
+    return false;
+  }
+  uint32_t size = GetSize();
+  memcpy(bucket_page_ids_ + size, bucket_page_ids_, size * sizeof(page_id_t));
+  memcpy(LocalDepths() + size, LocalDepths(), size);
+  global_depth_++;
+  return true;
+}
+
+/*
+ * the local depths follow the page ids of all 1 << max depth slots
+ */
+uint8_t *HashTableDirectoryPage::LocalDepths() {
+  return reinterpret_cast<uint8_t *>(bucket_page_ids_ + (1u << max_depth_));
+}
+
+const uint8_t *HashTableDirectoryPage::LocalDepths() const {
+  return reinterpret_cast<const uint8_t *>(bucket_page_ids_ +
+                                           (1u << max_depth_));
+}
+
+} // namespace cmudb
@@ -0,0 +1,54 @@
+/**
+ * hash_table_header_page.cpp
+ */
+
+#include <cassert>
+
+#include "page/hash_table_header_page.h"
+
+namespace cmudb {
+
+/*
+ * Init method after creating a new header page
+ */
+void HashTableHeaderPage::Init(page_id_t page_id, size_t page_size, int depth,
+                               int directory_max_depth) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  size_t slots =
+      (page_size - sizeof(HashTableHeaderPage)) / sizeof(page_id_t);
+  int max_depth = 0;
+  while ((static_cast<size_t>(2) << max_depth) <= slots) {
+    max_depth++;
+  }
+  depth_ = depth < 0 || depth > max_depth ? max_depth : depth;
+  directory_max_depth_ = directory_max_depth;
+  for (uint32_t i = 0; i < GetSize(); i++) {
+    directory_page_ids_[i] = INVALID_PAGE_ID;
+  }
+}
+
+page_id_t HashTableHeaderPage::GetPageId() const { return page_id_; }
+int HashTableHeaderPage::GetDepth() const { return depth_; }
+int HashTableHeaderPage::GetDirectoryMaxDepth() const {
+  return directory_max_depth_;
+}
+uint32_t HashTableHeaderPage::GetSize() const { return 1u << depth_; }
+
+uint32_t HashTableHeaderPage::HashToDirectoryIndex(uint32_t hash) const {
+  // a 32 bit shift is undefined
+  return depth_ == 0 ? 0 : hash >> (32 - depth_);
+}
+
+page_id_t HashTableHeaderPage::GetDirectoryPageId(uint32_t index) const {
+  assert(index < GetSize());
+  return directory_page_ids_[index];
+}
+
+void HashTableHeaderPage::SetDirectoryPageId(uint32_t index,
+                                             page_id_t directory_page_id) {
+  assert(index < GetSize());
+  directory_page_ids_[index] = directory_page_id;
+}
+
+} // namespace cmudb
@@ -21,6 +21,9 @@ bool HeaderPage::InsertRecord(const std::string &name,
   // check for duplicate name
   if (FindRecord(name) != -1)
     return false;
+  // the page is full
+  if (offset + 36 > static_cast<int>(GetPageSize()))
+    return false;
   // copy record content
   memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
   memcpy((GetData() + offset + 32), &root_id, 4);
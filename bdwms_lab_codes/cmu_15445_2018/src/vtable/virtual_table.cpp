@@ -44,11 +44,13 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
     // create index object, allocate memory space
     IndexMetadata *index_metadata =
         ParseIndexStatement(index_string, std::string(argv[2]), schema);
-    index = ConstructIndex(index_metadata, buffer_pool_manager);
+    index = ConstructIndex(index_metadata,
+                           buffer_pool_manager->GetRegion(PoolRegion::INDEX));
   }
   // create table object, allocate memory space
-  VirtualTable *table = new VirtualTable(schema, buffer_pool_manager,
-                                         lock_manager, log_manager, index);
+  VirtualTable *table = new VirtualTable(
+      schema, buffer_pool_manager->GetRegion(PoolRegion::DATA), lock_manager,
+      log_manager, index);
 
   // insert table root page info into header page
   header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
@@ -92,11 +94,13 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
     // Retrieve index root page info from header page
     page_id_t index_root_id;
     header_page->GetRootId(index_metadata->GetName(), index_root_id);
-    index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
+    index = ConstructIndex(index_metadata,
+                           buffer_pool_manager->GetRegion(PoolRegion::INDEX),
+                           index_root_id);
   }
   VirtualTable *table =
-      new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
-                       index, table_root_id);
+      new VirtualTable(schema, buffer_pool_manager->GetRegion(PoolRegion::DATA),
+                       lock_manager, log_manager, index, table_root_id);
 
   // register virtual table within sqlite system
   schema_string = "CREATE TABLE X(" + schema_string + ");";
@@ -144,6 +148,13 @@ int VtabBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
 
   if (counter == (int)key_attrs.size() && is_index_scan) {
     pIdxInfo->idxNum = 1;
+    if (table->GetIndex()->GetMetadata()->GetIndexType() == IndexType::HASH) {
+      // directory and bucket page, at most one row (unique key). Not flagged
+      // SQLITE_INDEX_SCAN_UNIQUE: that lets sqlite delete in one pass, after
+      // VtabClose has committed the transaction
+      pIdxInfo->estimatedCost = 2;
+      pIdxInfo->estimatedRows = 1;
+    }
   }
   return SQLITE_OK;
 }
@@ -359,7 +370,8 @@ __declspec(dllexport)
   bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
   // init storage engine
-  storage_engine_ = new StorageEngine(db_file_name);
+  storage_engine_ =
+      new StorageEngine(db_file_name, PAGE_SIZE, BUFFER_POOL_SIZE, true);
   // start the logging
   storage_engine_->log_manager_->RunFlushThread();
   // create header page from BufferPoolManager if necessary
@@ -443,8 +455,18 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   std::string index_name;
   std::vector<int> key_attrs;
   int column_id = -1;
+  IndexType index_type = IndexType::BPLUS_TREE;
   // prepocess, transform sql string into lower case
   std::transform(sql.begin(), sql.end(), sql.begin(), ::tolower);
+  // "index_name a, b using hash" asks for a hash index
+  const std::string using_hash = " using hash";
+  StringUtility::Trim(sql);
+  if (sql.size() > using_hash.size() &&
+      sql.compare(sql.size() - using_hash.size(), using_hash.size(),
+                  using_hash) == 0) {
+    index_type = IndexType::HASH;
+    sql.resize(sql.size() - using_hash.size());
+  }
   n = sql.find_first_of(' ');
   // NOTE: must use whitespace to seperate index name and indexed column names
   assert(n != std::string::npos);
@@ -463,7 +485,7 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
     throw Exception(EXCEPTION_TYPE_INDEX, "can't create index, format error");
 
   IndexMetadata *metadata =
-      new IndexMetadata(index_name, table_name, schema, key_attrs);
+      new IndexMetadata(index_name, table_name, schema, key_attrs, index_type);
 
   // LOG_DEBUG("%s", metadata->ToString().c_str());
   return metadata;
@@ -514,6 +536,27 @@ Index *ConstructIndex(IndexMetadata *metadata,
   // for each varchar attribute, we assume the largest size is 16 bytes
   key_size += 16 * key_schema->GetUnlinedColumnCount();
 
+  if (metadata->GetIndexType() == IndexType::HASH) {
+    if (key_size <= 4) {
+      return new ExtendibleHashIndex<GenericKey<4>, RID, GenericComparator<4>>(
+          metadata, buffer_pool_manager, root_id);
+    } else if (key_size <= 8) {
+      return new ExtendibleHashIndex<GenericKey<8>, RID, GenericComparator<8>>(
+          metadata, buffer_pool_manager, root_id);
+    } else if (key_size <= 16) {
+      return new ExtendibleHashIndex<GenericKey<16>, RID,
+                                     GenericComparator<16>>(
+          metadata, buffer_pool_manager, root_id);
+    } else if (key_size <= 32) {
+      return new ExtendibleHashIndex<GenericKey<32>, RID,
+                                     GenericComparator<32>>(
+          metadata, buffer_pool_manager, root_id);
+    } else {
+      return new ExtendibleHashIndex<GenericKey<64>, RID,
+                                     GenericComparator<64>>(
+          metadata, buffer_pool_manager, root_id);
+    }
+  }
   if (key_size <= 4) {
     return new BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(
         metadata, buffer_pool_manager, root_id);
@@ -0,0 +1,127 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/replacer_test_util.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer<int> arc_replacer(4);
+  int value;
+
+  // frames 0..3 hold pages 100..103, page 101 and 102 are referenced twice
+  for (int i = 0; i < 4; ++i) {
+    arc_replacer.Load(i, 100 + i);
+    arc_replacer.Insert(i);
+  }
+  EXPECT_EQ(true, arc_replacer.Erase(1));
+  arc_replacer.Insert(1);
+  EXPECT_EQ(true, arc_replacer.Erase(2));
+  arc_replacer.Insert(2);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(2, arc_replacer.GetRecencyHits());
+
+  // T1 = {0, 3} is above its target of 0, evict its least recent page
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(0, value);
+
+  // page 100 comes back: ghost hit in B1 grows the target of T1
+  arc_replacer.Load(0, 100);
+  arc_replacer.Insert(0);
+  EXPECT_EQ(1, arc_replacer.GetGhostHits(false));
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+
+  // T1 = {3} is no longer above target, evict from T2 = {0, 2, 1}
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+
+  // page 101 comes back from B2 and shrinks the target again
+  arc_replacer.Load(1, 101);
+  arc_replacer.Insert(1);
+  EXPECT_EQ(1, arc_replacer.GetGhostHits(true));
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // pinned frames are skipped
+  EXPECT_EQ(true, arc_replacer.Erase(3));
+  EXPECT_EQ(true, arc_replacer.Victim(value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(2, arc_replacer.Size());
+}
+
+/*
+ * The workload alternates between a frequency-heavy phase (point lookups on a
+ * hot index with a scan in the background) and a recency-heavy phase (a
+ * sliding working set slightly smaller than the pool). Prints the hit ratio of
+ * each policy on the same reference string
+ */
+TEST(ARCReplacerTest, ShiftingWorkloadHitRatioBenchmark) {
+  const int num_frames = 64;
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int> hot(0, 47);
+  std::uniform_int_distribution<int> window(0, 55);
+
+  std::vector<page_id_t> refs;
+  int scan_page = 0;
+  int window_start = 0;
+  for (int phase = 0; phase < 20; ++phase) {
+    for (int i = 0; i < 5000; ++i) {
+      if (phase % 2 == 0) {
+        refs.push_back(hot(generator));
+        if (i % 2 == 0) {
+          refs.push_back(1000 + scan_page++);
+        }
+      } else {
+        refs.push_back(100000 + window_start + window(generator));
+        if (i % 50 == 0) {
+          window_start++;
+        }
+      }
+    }
+  }
+
+  LRUReplacer<int> lru_replacer;
+  LRUKReplacer<int> lru_k_replacer;
+  ARCReplacer<int> arc_replacer(num_frames);
+  double lru = ReplayHitRatio(&lru_replacer, num_frames, refs);
+  double lru_k = ReplayHitRatio(&lru_k_replacer, num_frames, refs);
+  double arc = ReplayHitRatio(&arc_replacer, num_frames, refs);
+  printf("%zu references, %d frames: LRU %.3f, LRU-2 %.3f, ARC %.3f "
+         "(B1 ghost hits %zu, B2 ghost hits %zu)\n",
+         refs.size(), num_frames, lru, lru_k, arc,
+         arc_replacer.GetGhostHits(false), arc_replacer.GetGhostHits(true));
+  EXPECT_GT(arc, lru);
+}
+
+TEST(ARCReplacerTest, BufferPoolHitRatioTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager, nullptr, 2, ReplacerType::ARC);
+  EXPECT_EQ(ReplacerType::ARC, bpm.GetReplacerType());
+
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // pages 4..7 are resident, 0..3 were evicted
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(7 - i));
+    EXPECT_EQ(true, bpm.UnpinPage(7 - i, false));
+  }
+  EXPECT_DOUBLE_EQ(0.5, bpm.GetHitRatio());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -2,7 +2,13 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -98,5 +104,742 @@ TEST(BufferPoolManagerTest, SampleTest2) {
   remove("test.db");
 }
 
+TEST(BufferPoolManagerTest, PartitionedTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // 10 frames split into 4 instances of 3, 3, 2, 2 frames
+  BufferPoolManager bpm(10, disk_manager, nullptr, 4);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, temp_page_id);
+  strcpy(page_zero->GetData(), "Hello");
+
+  // fill every instance, pages are spread round-robin by page id
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(i, temp_page_id);
+  }
+  // pages 10 and 11 belong to the full instances 2 and 3
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  EXPECT_EQ(true, bpm.UnpinPage(0, true));
+  EXPECT_EQ(false, bpm.CheckAllUnpined());
+  // page 12 maps to instance 0 again and evicts page zero
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(12, temp_page_id);
+  EXPECT_EQ(true, bpm.UnpinPage(12, false));
+
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, PartitionedConcurrentTest) {
+  const int num_threads = 8;
+  const int num_pages = 64;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(num_pages, disk_manager, nullptr, 4);
+  for (int i = 0; i < num_pages; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &temp_page_id, sizeof(page_id_t));
+    bpm.UnpinPage(temp_page_id, true);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.push_back(std::thread([&bpm, t] {
+      for (int round = 0; round < 100; ++round) {
+        for (int i = t; i < num_pages; i += num_threads) {
+          auto page = bpm.FetchPage(i);
+          EXPECT_NE(nullptr, page);
+          EXPECT_EQ(i, *reinterpret_cast<page_id_t *>(page->GetData()));
+          bpm.UnpinPage(i, false);
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const int pool_size = 10;
+  page_id_t temp_page_id;
+  char buf[PAGE_SIZE];
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  for (int i = 0; i < pool_size; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+  }
+  // a pinned dirty page is left alone
+  auto pinned = bpm.FetchPage(0);
+  strcpy(pinned->GetData(), "pinned");
+
+  bpm.RunPageCleaner(1.0);
+  for (int wait = 0; wait < 100; ++wait) {
+    disk_manager->ReadPage(pool_size - 1, buf);
+    if (strcmp(buf, "page 9") == 0) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  for (int i = 1; i < pool_size; ++i) {
+    disk_manager->ReadPage(i, buf);
+    EXPECT_EQ("page " + std::to_string(i), std::string(buf));
+  }
+  disk_manager->ReadPage(0, buf);
+  EXPECT_NE(std::string("pinned"), std::string(buf));
+
+  // once unpinned it gets written too, and evicting the clean frames loses
+  // nothing
+  bpm.UnpinPage(0, true);
+  for (int i = 0; i < pool_size - 1; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    bpm.UnpinPage(temp_page_id, false);
+  }
+  bpm.StopPageCleaner();
+  auto page = bpm.FetchPage(0);
+  EXPECT_EQ(std::string("pinned"), std::string(page->GetData()));
+  bpm.UnpinPage(0, false);
+  for (int i = 1; i < pool_size; ++i) {
+    page = bpm.FetchPage(i);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, PageCleanerConcurrentTest) {
+  const int num_threads = 4;
+  const int num_pages = 64;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(16, disk_manager, nullptr, 2);
+  for (int i = 0; i < num_pages; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    memset(page->GetData(), 0, sizeof(int));
+    bpm.UnpinPage(temp_page_id, true);
+  }
+
+  // every thread bumps a counter on its own pages while the cleaner writes
+  // them back behind its back
+  bpm.RunPageCleaner(0.75);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.push_back(std::thread([&bpm, t] {
+      for (int round = 0; round < 200; ++round) {
+        for (int i = t; i < num_pages; i += num_threads) {
+          auto page = bpm.FetchPage(i);
+          ASSERT_NE(nullptr, page);
+          page->WLatch();
+          int *counter = reinterpret_cast<int *>(page->GetData());
+          EXPECT_EQ(round, *counter);
+          (*counter)++;
+          page->WUnlatch();
+          bpm.UnpinPage(i, true);
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bpm.StopPageCleaner();
+  for (int i = 0; i < num_pages; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(200, *reinterpret_cast<int *>(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const int pool_size = 10;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  for (int i = 0; i < 3 * pool_size; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+  }
+  // pages 20..29 are resident; read 0..4 back in ahead of time
+  bpm.Prefetch(0, 5);
+  bpm.Prefetch(std::vector<page_id_t>{INVALID_PAGE_ID, 5});
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+  for (int i = 0; i < 6; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_EQ(1.0, bpm.GetHitRatio());
+
+  // fetching a page while it is still being read returns its data too
+  bpm.Prefetch(10, pool_size);
+  for (int i = 10; i < 10 + pool_size; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+
+TEST(BufferPoolManagerTest, SequentialRingTest) {
+  const int pool_size = 10;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  for (int i = 0; i < 4 * pool_size; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+  }
+  // pages 0..4 are the working set
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    bpm.UnpinPage(i, false);
+  }
+  // a scan over the other pages only recycles the ring
+  for (int i = 5; i < 4 * pool_size; ++i) {
+    auto page = bpm.FetchPage(i, AccessHint::SEQUENTIAL);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+  double hit_ratio = bpm.GetHitRatio();
+  for (int i = 0; i < 5; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_LT(hit_ratio, bpm.GetHitRatio());
+  // no frame went missing: the pool can still hold ten pinned pages
+  for (int i = 0; i < pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm.FetchPage(i, i % 2 ? AccessHint::SEQUENTIAL
+                                              : AccessHint::NORMAL));
+  }
+  EXPECT_EQ(nullptr, bpm.FetchPage(pool_size));
+  for (int i = 0; i < pool_size; ++i) {
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+/*
+ * Hits pin pages without latch_ while other threads keep missing and
+ * evicting: every hit must see its own page, and no pin may be lost
+ */
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const int pool_size = 16;
+  const int num_hot = 8;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  page_id_t temp_page_id;
+  for (int i = 0; i < 4 * pool_size; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.push_back(std::thread([&bpm, tid]() {
+      // three threads hit the hot pages, one scans the cold ones
+      for (int i = 0; i < 20000; ++i) {
+        page_id_t page_id = tid < 3 ? i % num_hot
+                                    : num_hot + i % (4 * pool_size - num_hot);
+        auto page = bpm.FetchPage(page_id);
+        if (page == nullptr) {
+          continue;  // every frame pinned for a moment
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ("page " + std::to_string(page_id),
+                  std::string(page->GetData()));
+        bpm.UnpinPage(page_id, false);
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  printf("hit ratio %.3f in %lld ms\n", bpm.GetHitRatio(),
+         static_cast<long long>(
+             std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                 .count()));
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+  // the hot pages were referenced all along and stayed resident
+  for (int i = 0; i < pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm.FetchPage(i));
+  }
+  for (int i = 0; i < pool_size; ++i) {
+    bpm.UnpinPage(i, false);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const int pool_size = 16;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager, nullptr, 2);
+  page_id_t temp_page_id;
+  for (int i = 0; i < pool_size; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    // page 3 stays pinned, it is written all the same
+    if (temp_page_id != 3) {
+      bpm.UnpinPage(temp_page_id, temp_page_id % 4 != 1);
+    }
+  }
+  bpm.UnpinPage(3, true);
+
+  // incremental: two pages per call, in page id order, wrapping around
+  EXPECT_EQ(2u, bpm.FlushPages(2 * PAGE_SIZE));
+  EXPECT_EQ(pool_size - 4u - 2u, bpm.GetStats().dirty_pages);
+  EXPECT_EQ(1u, bpm.FlushPages(0));
+  // a page written by an earlier call and dirtied again is written again
+  ASSERT_NE(nullptr, bpm.FetchPage(0));
+  bpm.UnpinPage(0, true);
+
+  EXPECT_EQ(pool_size - 4u - 2u, bpm.FlushAllPages());
+  EXPECT_EQ(0u, bpm.GetStats().dirty_pages);
+  EXPECT_EQ(pool_size - 4u + 1u, bpm.GetStats().flushed_pages);
+  EXPECT_EQ(0u, bpm.FlushAllPages());
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  // everything is in the file, read it with another disk manager
+  DiskManager reader("test.db");
+  char data[PAGE_SIZE];
+  for (int i = 0; i < pool_size; ++i) {
+    reader.ReadPage(i, data);
+    EXPECT_EQ(i % 4 == 1 ? std::string() : "page " + std::to_string(i),
+              std::string(data));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+/*
+ * Checkpoint of a full pool: one FlushPage per page versus FlushAllPages
+ */
+TEST(BufferPoolManagerTest, FlushAllPagesBenchmark) {
+  const int pool_size = 4096;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  page_id_t temp_page_id;
+  for (int i = 0; i < pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    bpm.UnpinPage(temp_page_id, true);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < pool_size; ++i) {
+    bpm.FlushPage(i);
+  }
+  auto middle = std::chrono::steady_clock::now();
+  for (int i = 0; i < pool_size; ++i) {
+    bpm.FetchPage(i);
+    bpm.UnpinPage(i, true);
+  }
+  auto restart = std::chrono::steady_clock::now();
+  EXPECT_EQ(static_cast<size_t>(pool_size), bpm.FlushAllPages());
+  auto end = std::chrono::steady_clock::now();
+  printf("FlushPage each %.2f ms, FlushAllPages %.2f ms\n",
+         std::chrono::duration<double, std::milli>(middle - start).count(),
+         std::chrono::duration<double, std::milli>(end - restart).count());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  const int pool_size = 10;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  page_id_t temp_page_id;
+  {
+    BufferPoolManager bpm(pool_size, disk_manager);
+    for (int i = 0; i < 3 * pool_size; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      bpm.UnpinPage(temp_page_id, true);
+    }
+    // resident: 20..29, of which 25..29 are used again, 29 last
+    for (int i = 25; i < 30; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      bpm.FetchPage(i);
+      bpm.UnpinPage(i, false);
+    }
+    bpm.FlushAllPages();
+    // saved a last time when the saver stops with the pool
+    bpm.RunResidentPageSaver("test.warm");
+  }
+
+  BufferPoolManager bpm(pool_size, disk_manager);
+  EXPECT_EQ(static_cast<size_t>(pool_size), bpm.WarmUp("test.warm"));
+  for (int i = 20; i < 30; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_EQ(1.0, bpm.GetHitRatio());
+
+  // a smaller pool keeps the most recently used pages, and evicts the least
+  // recently used of them first
+  BufferPoolManager small(4, disk_manager);
+  EXPECT_EQ(4u, small.WarmUp("test.warm"));
+  ASSERT_NE(nullptr, small.FetchPage(0));
+  small.UnpinPage(0, false);
+  for (int i = 27; i < 30; ++i) {
+    ASSERT_NE(nullptr, small.FetchPage(i));
+    small.UnpinPage(i, false);
+  }
+  EXPECT_DOUBLE_EQ(0.75, small.GetHitRatio());
+
+  EXPECT_EQ(0u, bpm.WarmUp("no_such_file.warm"));
+  delete disk_manager;
+
+  // a list left over from an older file of the same name
+  remove("test.db");
+  disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager fresh(pool_size, disk_manager);
+    EXPECT_EQ(0u, fresh.WarmUp("test.warm"));
+  }
+  delete disk_manager;
+  remove("test.db");
+  remove("test.warm");
+}
+
+TEST(BufferPoolManagerTest, RegionTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(std::vector<size_t>{4, 4}, disk_manager, nullptr, 2);
+  BufferPoolManager *data = bpm.GetRegion(PoolRegion::DATA);
+  BufferPoolManager *index = bpm.GetRegion(PoolRegion::INDEX);
+  EXPECT_NE(data, index);
+  page_id_t index_page_ids[2];
+  for (auto &page_id : index_page_ids) {
+    auto page = index->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "index %d", page_id);
+    index->UnpinPage(page_id, true);
+  }
+  // a scan through the data region does not touch the index pages
+  page_id_t page_id;
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, false);
+  }
+  for (auto page_id : index_page_ids) {
+    auto page = index->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("index " + std::to_string(page_id),
+              std::string(page->GetData()));
+    index->UnpinPage(page_id, false);
+  }
+  EXPECT_DOUBLE_EQ(1.0, index->GetHitRatio());
+
+  // a page is resident in one region only, whichever handle asks for it
+  Page *page = data->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(page, index->FetchPage(page_id));
+  EXPECT_TRUE(index->UnpinPage(page_id, false));
+  EXPECT_TRUE(data->UnpinPage(page_id, false));
+  EXPECT_EQ(page, bpm.FetchPage(page_id));
+  EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+  EXPECT_EQ(16u, bpm.GetStats().evictions);
+
+  // misses of the same page through both regions at once load it once
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.push_back(std::thread([&bpm, tid]() {
+      BufferPoolManager *region =
+          bpm.GetRegion(tid % 2 == 0 ? PoolRegion::DATA : PoolRegion::INDEX);
+      for (int i = 0; i < 2000; ++i) {
+        page_id_t id = i % 20;
+        auto page = region->FetchPage(id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(id, page->GetPageId());
+        region->UnpinPage(id, false);
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, RetainTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  page_id_t page_id;
+  Page *pages[3];
+  for (auto &page : pages) {
+    page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+  }
+  // at most half of the frames are retained
+  EXPECT_TRUE(bpm.Retain(pages[0]));
+  EXPECT_TRUE(bpm.Retain(pages[0]));
+  EXPECT_TRUE(bpm.Retain(pages[1]));
+  EXPECT_FALSE(bpm.Retain(pages[2]));
+  for (int i = 0; i < 3; ++i) {
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  // retained pages survive a scan
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, false);
+  }
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(pages[i], bpm.FetchPage(i));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_DOUBLE_EQ(1.0, bpm.GetHitRatio());
+
+  // but let go when every other frame is pinned
+  Page *pinned[2];
+  for (auto &page : pinned) {
+    page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+  }
+  ASSERT_NE(nullptr, bpm.NewPage(page_id));
+  bpm.UnpinPage(page_id, false);
+  for (auto page : pinned) {
+    bpm.UnpinPage(page->GetPageId(), false);
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  // deleting a retained page drops the pool's pin
+  ASSERT_NE(nullptr, bpm.FetchPage(0));
+  EXPECT_TRUE(bpm.Retain(bpm.FetchPage(0)));
+  bpm.UnpinPage(0, false);
+  bpm.UnpinPage(0, false);
+  EXPECT_TRUE(bpm.DeletePage(0));
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// evicted pages come back from the compressed cache instead of the disk, and
+// a page written while resident is not shadowed by an older cached copy
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager, nullptr, 2);
+  bpm.EnableCompressedCache(64 * bpm.GetPageSize());
+  page_id_t page_id;
+  for (int i = 0; i < 20; ++i) {
+    auto page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(16u, stats.compressed_pages);
+  EXPECT_LT(stats.compressed_bytes, 16 * bpm.GetPageSize() / 4);
+
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 20; ++i) {
+      auto page = bpm.FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      std::string expected = "page " + std::to_string(i);
+      if (round == 1 && i % 3 == 0) {
+        expected += " updated";
+      }
+      EXPECT_EQ(expected, std::string(page->GetData()));
+      if (round == 0 && i % 3 == 0) {
+        snprintf(page->GetData(), PAGE_SIZE, "page %d updated", i);
+      }
+      bpm.UnpinPage(i, round == 0 && i % 3 == 0);
+    }
+  }
+  stats = bpm.GetStats();
+  EXPECT_EQ(40u, stats.compressed_hits);
+  EXPECT_EQ(0u, stats.compressed_misses);
+  EXPECT_DOUBLE_EQ(1.0, stats.GetCompressedHitRatio());
+  EXPECT_NE(std::string::npos, stats.ToString().find("compressed_hits 40\n"));
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// a shrink moves pages into free frames or evicts them, waiting for pinned
+// ones; the frames come back when the pool grows again
+TEST(BufferPoolManagerTest, ResizeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(8, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 8; ++i) {
+    auto page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+  // two free frames to migrate into, one page pinned
+  EXPECT_TRUE(bpm.DeletePage(0));
+  EXPECT_TRUE(bpm.DeletePage(1));
+  Page *pinned = bpm.FetchPage(7);
+  ASSERT_NE(nullptr, pinned);
+  EXPECT_FALSE(bpm.Resize(9));
+  EXPECT_FALSE(bpm.Resize(0));
+  EXPECT_TRUE(bpm.Resize(4));
+  EXPECT_EQ(4u, bpm.GetPoolSize());
+
+  auto wait_for_frames = [&bpm](uint64_t frames) {
+    for (int i = 0; i < 500 && bpm.GetStats().pool_frames != frames; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return bpm.GetStats().pool_frames;
+  };
+  EXPECT_EQ(5u, wait_for_frames(5));
+  EXPECT_EQ(pinned, bpm.FetchPage(7));  // still where it was
+  bpm.UnpinPage(7, false);
+  bpm.UnpinPage(7, false);
+  EXPECT_EQ(4u, wait_for_frames(4));
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(1u, stats.pool_shrinks);
+  EXPECT_EQ(2u, stats.shrink_migrations);
+  EXPECT_EQ(2u, stats.shrink_evictions);
+
+  for (int i = 2; i < 8; ++i) {
+    auto page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm.UnpinPage(i, false);
+  }
+  // only four frames left to pin
+  Page *pages[5];
+  for (int i = 0; i < 4; ++i) {
+    pages[i] = bpm.FetchPage(i + 2);
+    ASSERT_NE(nullptr, pages[i]);
+  }
+  EXPECT_EQ(nullptr, bpm.FetchPage(6));
+
+  EXPECT_TRUE(bpm.Resize(8));
+  EXPECT_EQ(8u, bpm.GetStats().pool_frames);
+  EXPECT_EQ(1u, bpm.GetStats().pool_grows);
+  pages[4] = bpm.FetchPage(6);
+  ASSERT_NE(nullptr, pages[4]);
+  EXPECT_EQ("page 6", std::string(pages[4]->GetData()));
+  for (auto page : pages) {
+    bpm.UnpinPage(page->GetPageId(), false);
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+
+  // a partitioned pool splits the new size over its instances
+  BufferPoolManager partitioned(8, disk_manager, nullptr, 2);
+  EXPECT_TRUE(partitioned.Resize(3));
+  EXPECT_EQ(3u, partitioned.GetPoolSize());
+  EXPECT_FALSE(partitioned.Resize(1));
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// readers keep going, and see the right pages, while the pool shrinks and
+// grows under them
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(16, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 40; ++i) {
+    auto page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.push_back(std::thread([&bpm, &done, tid]() {
+      std::mt19937 gen(tid);
+      while (!done) {
+        page_id_t id = gen() % 40;
+        auto page = bpm.FetchPage(id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+        bpm.UnpinPage(id, gen() % 4 == 0);
+      }
+    }));
+  }
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(bpm.Resize(i % 2 == 0 ? 4 : 16));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(true, bpm.CheckAllUnpined());
+  EXPECT_EQ(10u, bpm.GetStats().pool_shrinks);
+
+  delete disk_manager;
+  remove("test.db");
+}
 
 } // namespace cmudb
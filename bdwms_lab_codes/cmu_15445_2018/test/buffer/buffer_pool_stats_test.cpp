@@ -0,0 +1,132 @@
+/**
+ * buffer_pool_stats_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(BufferPoolStatsTest, SampleTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, i % 2 == 0);
+  }
+  // pages 2..5 are resident, 2 and 4 dirty; 0 and 1 were evicted, 0 dirty
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(2u, stats.evictions);
+  EXPECT_EQ(1u, stats.dirty_writebacks);
+  EXPECT_EQ(2u, stats.dirty_pages);
+  EXPECT_EQ(0u, stats.eviction_log_flushes);
+  EXPECT_EQ(6u, stats.latch_acquisitions);
+  EXPECT_EQ(0u, stats.latch_waits);
+
+  // two hits, one miss evicting the clean page 3
+  EXPECT_NE(nullptr, bpm.FetchPage(2));
+  EXPECT_NE(nullptr, bpm.FetchPage(5));
+  bpm.UnpinPage(2, false);
+  bpm.UnpinPage(5, false);
+  EXPECT_NE(nullptr, bpm.FetchPage(0));
+  stats = bpm.GetStats();
+  EXPECT_EQ(2u, stats.fetch_hits);
+  EXPECT_EQ(1u, stats.fetch_misses);
+  EXPECT_EQ(3u, stats.evictions);
+  EXPECT_EQ(1u, stats.dirty_writebacks);
+
+  // with every frame pinned there is no victim
+  Page *pinned[3];
+  for (int i = 0; i < 3; ++i) {
+    pinned[i] = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, pinned[i]);
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(page_id));
+  EXPECT_EQ(nullptr, bpm.FetchPage(1));
+  EXPECT_EQ(2u, bpm.GetStats().pin_failures);
+
+  std::string text = bpm.GetStats().ToString();
+  EXPECT_NE(std::string::npos, text.find("pin_failures 2\n"));
+  EXPECT_NE(std::string::npos, text.find("latch_wait_lt_1us 0\n"));
+  std::string json = bpm.GetStats().ToJson();
+  EXPECT_EQ('{', json.front());
+  EXPECT_EQ('}', json.back());
+  EXPECT_NE(std::string::npos, json.find("\"fetch_misses\":2"));
+
+  bpm.UnpinPage(0, false);
+  for (int i = 0; i < 3; ++i) {
+    bpm.UnpinPage(pinned[i]->GetPageId(), false);
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+// counters of a partitioned pool add up over its instances
+TEST(BufferPoolStatsTest, PartitionedTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager, nullptr, 2);
+  page_id_t page_id;
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, true);
+  }
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(4u, stats.evictions);
+  EXPECT_EQ(4u, stats.dirty_writebacks);
+  EXPECT_EQ(4u, stats.dirty_pages);
+  for (int i = 4; i < 8; ++i) {
+    EXPECT_NE(nullptr, bpm.FetchPage(i));
+    bpm.UnpinPage(i, false);
+  }
+  EXPECT_DOUBLE_EQ(1.0, bpm.GetHitRatio());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// many threads missing at once wait for latch_, and each wait is recorded
+TEST(BufferPoolStatsTest, LatchWaitTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(8, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 64; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, false);
+  }
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.push_back(std::thread([&bpm, tid]() {
+      for (int i = 0; i < 2000; ++i) {
+        page_id_t id = (tid * 17 + i) % 64;
+        if (bpm.FetchPage(id) != nullptr) {
+          bpm.UnpinPage(id, false);
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(8000u, stats.fetch_hits + stats.fetch_misses);
+  uint64_t bucketed = 0;
+  for (auto count : stats.latch_wait_histogram) {
+    bucketed += count;
+  }
+  EXPECT_EQ(stats.latch_waits, bucketed);
+  EXPECT_LE(stats.latch_waits, stats.latch_acquisitions);
+  printf("%s", stats.ToString().c_str());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -0,0 +1,120 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7);
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // first sweep clears every reference bit, then frames go in clock order
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(3));
+  EXPECT_EQ(true, clock_replacer.Erase(4));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // a referenced frame gets a second chance
+  clock_replacer.Insert(5);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, BasicTest) {
+  ClockReplacer<int> clock_replacer(100);
+  int value;
+
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+  for (int i = 0; i < 100; ++i) {
+    clock_replacer.Insert(i);
+  }
+  EXPECT_EQ(100, clock_replacer.Size());
+
+  // erase the first half
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(true, clock_replacer.Erase(i));
+  }
+  for (int i = 50; i < 100; ++i) {
+    EXPECT_EQ(true, clock_replacer.Victim(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+TEST(ClockReplacerTest, PreferredVictimTest) {
+  ClockReplacer<int> clock_replacer(10);
+  auto even = [](const int &value) { return value % 2 == 0; };
+  int value;
+
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  // odd frames are passed over while there is an even one
+  EXPECT_EQ(true, clock_replacer.PreferredVictim(value, even));
+  EXPECT_EQ(4, value);
+  // none left, fall back to clock order from where the hand stopped
+  EXPECT_EQ(true, clock_replacer.PreferredVictim(value, even));
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(2, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, BufferPoolTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, 1, ReplacerType::CLOCK);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  strcpy(page_zero->GetData(), "Hello");
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(14, false));
+
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -0,0 +1,68 @@
+/**
+ * compressed_page_cache_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/compressed_page_cache.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(CompressedPageCacheTest, SampleTest) {
+  const size_t page_size = 4096;
+  CompressedPageCache cache(64 * 1024, page_size);
+  std::vector<char> page(page_size, 0);
+  std::vector<char> out(page_size);
+  for (int i = 0; i < 10; ++i) {
+    snprintf(page.data(), page_size, "page %d", i);
+    cache.Insert(i, page.data());
+  }
+  EXPECT_EQ(10u, cache.GetNumPages());
+  // mostly zeroes, so far smaller than the pages
+  EXPECT_LT(cache.GetBytes(), 10 * page_size / 8);
+
+  EXPECT_TRUE(cache.Take(3, out.data()));
+  EXPECT_EQ("page 3", std::string(out.data()));
+  // taken out
+  EXPECT_FALSE(cache.Take(3, out.data()));
+  EXPECT_EQ(9u, cache.GetNumPages());
+  cache.Erase(4);
+  EXPECT_FALSE(cache.Take(4, out.data()));
+  EXPECT_EQ(1u, cache.GetHits());
+  EXPECT_EQ(2u, cache.GetMisses());
+
+  // a newer copy replaces the old one
+  snprintf(page.data(), page_size, "page 5 again");
+  cache.Insert(5, page.data());
+  EXPECT_EQ(8u, cache.GetNumPages());
+  EXPECT_TRUE(cache.Take(5, out.data()));
+  EXPECT_EQ("page 5 again", std::string(out.data()));
+}
+
+// the oldest pages are dropped to stay within capacity; pages that do not
+// compress are kept as they are
+TEST(CompressedPageCacheTest, CapacityTest) {
+  const size_t page_size = 512;
+  CompressedPageCache cache(4 * page_size, page_size);
+  std::vector<char> page(page_size);
+  std::mt19937 gen(15445);
+  for (int i = 0; i < 6; ++i) {
+    for (auto &c : page) {
+      c = static_cast<char>(gen());
+    }
+    cache.Insert(i, page.data());
+    EXPECT_LE(cache.GetBytes(), cache.GetCapacity());
+  }
+  EXPECT_EQ(4u, cache.GetNumPages());
+  EXPECT_EQ(4 * page_size, cache.GetBytes());
+  std::vector<char> out(page_size);
+  EXPECT_FALSE(cache.Take(0, out.data()));
+  EXPECT_FALSE(cache.Take(1, out.data()));
+  EXPECT_TRUE(cache.Take(5, out.data()));
+  EXPECT_EQ(page, out);
+}
+
+} // namespace cmudb
@@ -0,0 +1,158 @@
+/**
+ * frame_arena_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <unistd.h>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(FrameArenaTest, SampleTest) {
+  FrameArena empty(0);
+  EXPECT_EQ(nullptr, empty.GetData());
+
+  // small arenas are aligned on the OS page
+  FrameArena small(10 * PAGE_SIZE, true);
+  ASSERT_NE(nullptr, small.GetData());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(small.GetData()) %
+                    static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)));
+  for (size_t i = 0; i < small.GetSize(); ++i) {
+    ASSERT_EQ(0, small.GetData()[i]);
+  }
+
+  // large ones on the huge page
+  FrameArena large(HUGE_PAGE_SIZE + 4096);
+  ASSERT_NE(nullptr, large.GetData());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(large.GetData()) % HUGE_PAGE_SIZE);
+  large.GetData()[large.GetSize() - 1] = 'a';
+  EXPECT_EQ('a', large.GetData()[large.GetSize() - 1]);
+}
+
+TEST(FrameArenaTest, BufferPoolFramesTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(8, disk_manager, nullptr, 1, ReplacerType::LRU, true);
+
+  // frames are adjacent slices of one aligned arena
+  page_id_t page_id;
+  std::vector<char *> data;
+  for (int i = 0; i < 8; ++i) {
+    Page *page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    EXPECT_EQ(0, page->GetData()[0]);
+    data.push_back(page->GetData());
+  }
+  std::sort(data.begin(), data.end());
+  for (size_t i = 1; i < data.size(); ++i) {
+    EXPECT_EQ(static_cast<ptrdiff_t>(PAGE_SIZE), data[i] - data[i - 1]);
+  }
+  for (page_id_t i = 0; i < 8; ++i) {
+    bpm.UnpinPage(i, false);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// dTLB load misses of this thread, -1 if perf events are not available
+static int OpenTLBCounter() {
+#ifdef __linux__
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+  return -1;
+#endif
+}
+
+/*
+ * Read one word of a random frame, which is what a hit in a large buffer
+ * pool costs once the page table has been consulted. Frames live either in
+ * a plain heap allocation (the old layout) or in a prefaulted FrameArena
+ */
+TEST(FrameArenaTest, TLBBenchmark) {
+  const size_t page_size = 4096;
+  const size_t num_frames = 16384; // 64MB of frames
+  const size_t num_reads = 4000000;
+  std::mt19937 gen(15445);
+  std::vector<uint32_t> frames(num_reads);
+  for (auto &frame : frames) {
+    frame = gen() % num_frames;
+  }
+
+  printf("%12s %10s %14s\n", "layout", "ms", "dTLB misses");
+  for (int use_arena = 0; use_arena < 2; ++use_arena) {
+    char *heap = nullptr;
+    FrameArena *arena = nullptr;
+    char *data;
+    if (use_arena) {
+      arena = new FrameArena(num_frames * page_size, true);
+      data = arena->GetData();
+    } else {
+      heap = new char[num_frames * page_size];
+      memset(heap, 0, num_frames * page_size);
+      data = heap;
+    }
+
+    int fd = OpenTLBCounter();
+#ifdef __linux__
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (auto frame : frames) {
+      sum += *reinterpret_cast<uint64_t *>(data + frame * page_size + 64);
+    }
+    auto end = std::chrono::steady_clock::now();
+    long long misses = -1;
+    if (fd >= 0) {
+#ifdef __linux__
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+      if (read(fd, &misses, sizeof(misses)) != sizeof(misses)) {
+        misses = -1;
+      }
+      close(fd);
+    }
+    EXPECT_EQ(0u, sum);
+
+    char misses_str[32] = "n/a";
+    if (misses >= 0) {
+      snprintf(misses_str, sizeof(misses_str), "%lld", misses);
+    }
+    printf("%12s %10lld %14s\n", use_arena ? "arena" : "heap",
+           static_cast<long long>(
+               std::chrono::duration_cast<std::chrono::milliseconds>(
+                   end - start).count()),
+           misses_str);
+    delete arena;
+    delete[] heap;
+  }
+}
+
+} // namespace cmudb
@@ -0,0 +1,118 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/replacer_test_util.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(2, 0);
+
+  // frames 1 and 2 are referenced twice, the others once
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Insert(2);
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // infinite k-distance first, oldest reference first
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  // then by backward 2-distance
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+
+  // pinned frames keep their history
+  lru_k_replacer.Insert(6);
+  EXPECT_EQ(true, lru_k_replacer.Erase(2));
+  EXPECT_EQ(false, lru_k_replacer.Erase(2));
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer<int> lru_k_replacer(2, 1);
+  int value;
+
+  // back-to-back references to frame 1 are one correlated reference
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+
+  // loading a new page into a frame forgets the old page's history
+  lru_k_replacer.Load(2, 100);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+}
+
+/*
+ * Mixed workload: point lookups walk root -> internal -> leaf of an index
+ * while a report scan keeps walking heap pages, reading several tuples from
+ * each page. Prints the hit ratio of LRU and LRU-2 on the same reference string
+ */
+TEST(LRUKReplacerTest, ScanPointHitRatioBenchmark) {
+  const int num_frames = 64;
+  const int num_internal = 8;
+  const int num_leaves = 48;
+  const int heap_first_page = 1000;
+  const int heap_pages = 4000;
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int> leaf(0, num_leaves - 1);
+
+  std::vector<page_id_t> refs;
+  int scan_page = 0;
+  for (int round = 0; round < 2000; ++round) {
+    for (int i = 0; i < 20; ++i) {
+      int l = leaf(generator);
+      refs.push_back(0);
+      refs.push_back(1 + l % num_internal);
+      refs.push_back(1 + num_internal + l);
+    }
+    for (int i = 0; i < 16; ++i) {
+      for (int tuple = 0; tuple < 4; ++tuple) {
+        refs.push_back(heap_first_page + scan_page);
+      }
+      scan_page = (scan_page + 1) % heap_pages;
+    }
+  }
+
+  LRUReplacer<int> lru_replacer;
+  LRUKReplacer<int> lru_k_replacer;
+  double lru = ReplayHitRatio(&lru_replacer, num_frames, refs);
+  double lru_k = ReplayHitRatio(&lru_k_replacer, num_frames, refs);
+  printf("%zu references, %d frames: LRU hit ratio %.3f, LRU-2 hit ratio "
+         "%.3f\n",
+         refs.size(), num_frames, lru, lru_k);
+  EXPECT_GT(lru_k, lru);
+}
+
+} // namespace cmudb
@@ -0,0 +1,89 @@
+/**
+ * page_guard_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PageGuardTest, SampleTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, false);
+  }
+
+  {
+    WritePageGuard guard = bpm.FetchPageWrite(0);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    EXPECT_EQ(0, guard.GetPageId());
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    strcpy(guard.GetData(), "Hello");
+  }
+  // released dirty, so page 0 survives eviction
+  {
+    ReadPageGuard guard1 = bpm.FetchPageRead(1);
+    ReadPageGuard guard2 = bpm.FetchPageRead(2);
+    ASSERT_TRUE(static_cast<bool>(guard1));
+    ASSERT_TRUE(static_cast<bool>(guard2));
+    // both frames are held by the guards
+    EXPECT_FALSE(static_cast<bool>(bpm.FetchPageRead(0)));
+
+    // moving hands the pin over instead of taking another one
+    ReadPageGuard moved(std::move(guard1));
+    EXPECT_FALSE(static_cast<bool>(guard1));
+    EXPECT_EQ(1, moved.GetPage()->GetPinCount());
+    moved.Release();
+    EXPECT_FALSE(static_cast<bool>(moved));
+
+    // assignment releases the page the guard held before
+    guard2 = bpm.FetchPageRead(0);
+    ASSERT_TRUE(static_cast<bool>(guard2));
+    EXPECT_EQ(0, strcmp(guard2.GetData(), "Hello"));
+  }
+  EXPECT_TRUE(bpm.CheckAllUnpined());
+
+  // a page adopted by a guard is released through it
+  Page *page = bpm.FetchPage(1);
+  page->WLatch();
+  {
+    WritePageGuard guard(&bpm, page);
+    guard.SetDirty(false);
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(PageGuardTest, PartitionedTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager, nullptr, 2);
+  page_id_t page_id;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(page_id));
+    bpm.UnpinPage(page_id, false);
+  }
+  {
+    WritePageGuard guard0 = bpm.FetchPageWrite(0);
+    ReadPageGuard guard1 = bpm.FetchPageRead(1);
+    ASSERT_TRUE(static_cast<bool>(guard0));
+    ASSERT_TRUE(static_cast<bool>(guard1));
+    guard1 = bpm.FetchPageRead(3);
+    EXPECT_EQ(3, guard1.GetPageId());
+  }
+  EXPECT_TRUE(bpm.CheckAllUnpined());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
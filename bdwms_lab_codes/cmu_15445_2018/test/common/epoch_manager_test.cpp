@@ -0,0 +1,78 @@
+/**
+ * epoch_manager_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "common/epoch_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(EpochManagerTest, SampleTest) {
+  int freed = 0;
+  EpochManager epochs;
+  {
+    EpochGuard guard(epochs);
+    epochs.RetireCallback([&freed] { freed++; });
+    // the reader might still hold it
+    EXPECT_EQ(1u, epochs.Reclaim());
+    EXPECT_EQ(0, freed);
+  }
+  EXPECT_EQ(0u, epochs.Reclaim());
+  EXPECT_EQ(1, freed);
+
+  // a reader that entered after the retire does not hold it back
+  EpochGuard guard(epochs);
+  epochs.RetireCallback([&freed] { freed++; });
+  EXPECT_EQ(1u, epochs.Reclaim());
+  EpochGuard later(epochs);
+  {
+    EpochGuard inner(epochs);
+    epochs.RetireCallback([&freed] { freed++; });
+  }
+  EXPECT_EQ(2u, epochs.Reclaim());
+  EXPECT_EQ(1, freed);
+}
+
+// readers never see a pointer that was already freed
+TEST(EpochManagerTest, ConcurrentTest) {
+  struct Node {
+    int value;
+  };
+  EpochManager epochs;
+  std::atomic<Node *> shared(new Node{0});
+  std::atomic<bool> done(false);
+  std::atomic<int> wrong(0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.push_back(std::thread([&]() {
+      while (!done) {
+        EpochGuard guard(epochs);
+        Node *node = shared.load();
+        if (node->value < 0) {
+          wrong++;
+        }
+      }
+    }));
+  }
+  for (int i = 1; i <= 10000; ++i) {
+    Node *old = shared.exchange(new Node{i});
+    // poisoned when freed too early; ASan reports the use after free
+    epochs.RetireCallback([old] {
+      old->value = -1;
+      delete old;
+    });
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong.load());
+  EXPECT_EQ(0u, epochs.Reclaim());
+  delete shared.load();
+}
+
+} // namespace cmudb
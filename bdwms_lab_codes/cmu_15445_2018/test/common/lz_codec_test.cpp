@@ -0,0 +1,78 @@
+/**
+ * lz_codec_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/lz_codec.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+static void RoundTrip(const std::vector<char> &input, size_t max_size) {
+  std::vector<char> compressed(input.size() + 16);
+  size_t size = LZCodec::Compress(input.data(), input.size(),
+                                  compressed.data(), compressed.size());
+  ASSERT_NE(0u, size);
+  EXPECT_LE(size, max_size);
+  std::vector<char> output(input.size());
+  EXPECT_TRUE(LZCodec::Decompress(compressed.data(), size, output.data(),
+                                  output.size()));
+  EXPECT_EQ(input, output);
+}
+
+TEST(LZCodecTest, RoundTripTest) {
+  // zeroed page
+  RoundTrip(std::vector<char>(4096, 0), 32);
+  // empty input
+  RoundTrip(std::vector<char>(), 1);
+  // slotted-page like content: repeated records with a counter
+  std::vector<char> records(4096, 0);
+  for (int i = 0; i < 100; ++i) {
+    snprintf(records.data() + i * 40, 40, "record %04d name_%d value", i, i % 7);
+  }
+  RoundTrip(records, 4096 / 2);
+  // long literal runs and matches need the extended lengths
+  std::vector<char> mixed(70000);
+  std::mt19937 gen(15445);
+  for (size_t i = 0; i < mixed.size(); ++i) {
+    mixed[i] = i < 1000 || i > 40000 ? static_cast<char>(gen()) : 'x';
+  }
+  RoundTrip(mixed, mixed.size());
+}
+
+TEST(LZCodecTest, IncompressibleTest) {
+  std::vector<char> random(4096);
+  std::mt19937 gen(15445);
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  std::vector<char> compressed(4096);
+  // random data does not get smaller, so it does not fit
+  EXPECT_EQ(0u, LZCodec::Compress(random.data(), random.size(),
+                                  compressed.data(), random.size() - 1));
+}
+
+TEST(LZCodecTest, CorruptInputTest) {
+  std::vector<char> input(512, 'a');
+  std::vector<char> compressed(512);
+  size_t size = LZCodec::Compress(input.data(), input.size(),
+                                  compressed.data(), compressed.size());
+  ASSERT_NE(0u, size);
+  std::vector<char> output(512);
+  // wrong output size
+  EXPECT_FALSE(LZCodec::Decompress(compressed.data(), size, output.data(),
+                                   output.size() - 1));
+  // truncated in the middle of the match length
+  EXPECT_FALSE(LZCodec::Decompress(compressed.data(), size - 2, output.data(),
+                                   output.size()));
+  // offset before the start of the output
+  const char bad[] = {0x10, 'a', 0x05, 0x00};
+  EXPECT_FALSE(LZCodec::Decompress(bad, sizeof(bad), output.data(),
+                                   output.size()));
+}
+
+} // namespace cmudb
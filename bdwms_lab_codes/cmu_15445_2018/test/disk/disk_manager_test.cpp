@@ -0,0 +1,229 @@
+/**
+ * disk_manager_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "disk/async_io.h"
+#include "disk/disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DiskManagerTest, PageSizeTest) {
+  remove("test.db");
+  const size_t page_size = 4096;
+  char buf[page_size];
+  char data[page_size];
+
+  DiskManager *disk_manager = new DiskManager("test.db", page_size);
+  EXPECT_EQ(page_size, disk_manager->GetPageSize());
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    memset(data, 'a' + page_id, page_size);
+    disk_manager->WritePage(page_id, data);
+  }
+  delete disk_manager;
+
+  // the file keeps the page size it was created with
+  disk_manager = new DiskManager("test.db", 512);
+  EXPECT_EQ(page_size, disk_manager->GetPageSize());
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    memset(data, 'a' + page_id, page_size);
+    disk_manager->ReadPage(page_id, buf);
+    EXPECT_EQ(0, memcmp(buf, data, page_size));
+  }
+
+  // and so does a buffer pool on top of it
+  BufferPoolManager bpm(4, disk_manager);
+  EXPECT_EQ(page_size, bpm.GetPageSize());
+  auto page = bpm.FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(page_size, page->GetPageSize());
+  EXPECT_EQ('d', page->GetData()[page_size - 1]);
+  bpm.UnpinPage(3, false);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// threads doing page I/O at the same time don't get in each other's way
+TEST(DiskManagerTest, ConcurrentIOTest) {
+  remove("test.db");
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  const size_t page_size = disk_manager->GetPageSize();
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([=]() {
+      std::vector<char> data(page_size);
+      std::vector<char> buf(page_size);
+      // interleaved page ids, so neighbouring pages belong to other threads
+      for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + tid;
+          memset(data.data(), 'a' + (page_id + round) % 26, page_size);
+          disk_manager->WritePage(page_id, data.data());
+          disk_manager->ReadPage(page_id, buf.data());
+          EXPECT_EQ(0, memcmp(buf.data(), data.data(), page_size));
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // all of those writes take one sync, and a sync with nothing new is free
+  int syncs = disk_manager->GetNumSyncs();
+  disk_manager->Sync();
+  EXPECT_EQ(syncs + 1, disk_manager->GetNumSyncs());
+  disk_manager->Sync();
+  EXPECT_EQ(syncs + 1, disk_manager->GetNumSyncs());
+
+  // several pages at once, and reading past the end of the file
+  const page_id_t num_pages = num_threads * pages_per_thread;
+  std::vector<char> buf(2 * page_size);
+  disk_manager->ReadPages(num_pages - 1, buf.data(), 2);
+  EXPECT_EQ('a' + (num_pages - 1 + 3) % 26, buf[0]);
+  EXPECT_EQ('a' + (num_pages - 1 + 3) % 26, buf[page_size - 1]);
+  EXPECT_EQ(0, buf[page_size]);
+  EXPECT_EQ(0, buf[2 * page_size - 1]);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// many asynchronous page I/Os in flight at once, more than the queue holds
+TEST(DiskManagerTest, AsyncIOTest) {
+  remove("test.db");
+  const int num_pages = 3 * ASYNC_IO_QUEUE_DEPTH;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  const size_t page_size = disk_manager->GetPageSize();
+  std::vector<char> data(num_pages * page_size);
+  std::vector<std::future<bool>> writes;
+  for (int i = 0; i < num_pages; ++i) {
+    memset(&data[i * page_size], 'a' + i % 26, page_size);
+    writes.push_back(disk_manager->WritePageAsync(i, &data[i * page_size]));
+  }
+  disk_manager->SubmitAsync();
+  for (auto &write : writes) {
+    EXPECT_TRUE(write.get());
+  }
+  // the asynchronous writes count for Sync
+  disk_manager->Sync();
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+
+  std::vector<char> buf(num_pages * page_size);
+  std::vector<std::future<bool>> reads;
+  for (int i = num_pages - 1; i >= 0; --i) {
+    reads.push_back(disk_manager->ReadPageAsync(i, &buf[i * page_size]));
+  }
+  disk_manager->SubmitAsync();
+  for (auto &read : reads) {
+    EXPECT_TRUE(read.get());
+  }
+  EXPECT_EQ(0, memcmp(buf.data(), data.data(), buf.size()));
+
+  // with a callback, and past the end of the file
+  std::promise<bool> done;
+  memset(buf.data(), 'x', page_size);
+  disk_manager->ReadPageAsync(num_pages + 10, buf.data(),
+                              [&done](bool ok) { done.set_value(ok); });
+  disk_manager->SubmitAsync();
+  EXPECT_TRUE(done.get_future().get());
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[page_size - 1]);
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+// the pread/pwrite fallback behaves like the io_uring it stands in for
+TEST(DiskManagerTest, ThreadPoolIOTest) {
+  remove("test.db");
+  int fd = open("test.db", O_RDWR | O_CREAT, 0644);
+  ASSERT_LE(0, fd);
+  const size_t size = 512;
+  const int num_requests = 100;
+  std::vector<char> data(num_requests * size);
+  std::vector<char> buf(num_requests * size, 'x');
+  std::vector<char> past_end(size, 'x');
+  {
+    // a queue of 8, so Write has to submit and wait for room by itself
+    ThreadPoolIO io(fd, 8, 2);
+    std::atomic<int> written(0);
+    for (int i = 0; i < num_requests; ++i) {
+      memset(&data[i * size], 'a' + i % 26, size);
+      io.Write(&data[i * size], size, i * size, [&written](bool ok) {
+        EXPECT_TRUE(ok);
+        written++;
+      });
+    }
+    io.Submit();
+    // requests in flight together may complete in any order
+    while (written < num_requests) {
+      std::this_thread::yield();
+    }
+    for (int i = num_requests - 1; i >= 0; --i) {
+      io.Read(&buf[i * size], size, i * size,
+              [](bool ok) { EXPECT_TRUE(ok); });
+    }
+    // past the end of the file reads as zeros
+    io.Read(past_end.data(), size, num_requests * size,
+            [](bool ok) { EXPECT_TRUE(ok); });
+    // the destructor submits what is left and waits for it
+  }
+  EXPECT_EQ(0, memcmp(buf.data(), data.data(), buf.size()));
+  EXPECT_EQ(std::vector<char>(size, 0), past_end);
+  close(fd);
+  remove("test.db");
+}
+
+/*
+ * Reading pages one at a time with ReadPage, against queueing them all with
+ * ReadPageAsync and submitting them together. The file is fresh, so it mostly
+ * comes out of the OS page cache
+ */
+TEST(DiskManagerTest, AsyncIOBenchmark) {
+  remove("test.db");
+  const int num_pages = 4096;
+  DiskManager *disk_manager = new DiskManager("test.db", 4096);
+  const size_t page_size = disk_manager->GetPageSize();
+  std::vector<char> data(num_pages * page_size, 'a');
+  disk_manager->WritePages(0, data.data(), num_pages);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; ++i) {
+    disk_manager->ReadPage((i * 7919) % num_pages, &data[i * page_size]);
+  }
+  auto middle = std::chrono::steady_clock::now();
+  std::vector<std::future<bool>> reads;
+  for (int i = 0; i < num_pages; ++i) {
+    reads.push_back(disk_manager->ReadPageAsync((i * 7919) % num_pages,
+                                                &data[i * page_size]));
+  }
+  disk_manager->SubmitAsync();
+  for (auto &read : reads) {
+    EXPECT_TRUE(read.get());
+  }
+  auto end = std::chrono::steady_clock::now();
+  printf("%d random page reads: %.1f ms one at a time, %.1f ms async\n",
+         num_pages,
+         std::chrono::duration<double, std::milli>(middle - start).count(),
+         std::chrono::duration<double, std::milli>(end - middle).count());
+
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
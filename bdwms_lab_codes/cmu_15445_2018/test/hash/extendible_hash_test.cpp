@@ -2,6 +2,10 @@
  * extendible_hash_test.cpp
  */
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
 #include <thread>
 #include <random>
 
@@ -279,7 +283,10 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
     for (int i = 0; i < num_threads; i++) {
       threads[i].join();
     }
-    EXPECT_EQ(test->GetGlobalDepth(), 6);
+    // the removes may have merged buckets and shrunk the directory, 4 to 8
+    // still need two bits
+    EXPECT_GE(6, test->GetGlobalDepth());
+    EXPECT_LE(2, test->GetGlobalDepth());
     int val;
     EXPECT_EQ(0, test->Find(0, val));
     EXPECT_EQ(1, test->Find(8, val));
@@ -289,4 +296,370 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
   }
 }
 
+// a full bucket splits, also when the keys share their fingerprints
+TEST(ExtendibleHashTest, FullBucketTest) {
+  ExtendibleHash<int, int> test(FINGERPRINT_GROUP + 3);
+  for (int i = 0; i < 10000; ++i) {
+    test.Insert(i * 1024, i);
+  }
+  int value;
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(test.Find(i * 1024, value));
+    EXPECT_EQ(i, value);
+    EXPECT_FALSE(test.Find(i * 1024 + 1, value));
+  }
+  for (int i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(test.Remove(i * 1024));
+  }
+  // removed slots are reused
+  for (int i = 0; i < 10000; i += 2) {
+    test.Insert(i * 1024, -i);
+  }
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(test.Find(i * 1024, value));
+    EXPECT_EQ(i % 2 == 0 ? -i : i, value);
+  }
+}
+
+// lock-free readers keep finding the keys while other threads split the
+// buckets and double the directory under them
+TEST(ExtendibleHashTest, ConcurrentFindTest) {
+  const int num_old = 1000;
+  const int num_new = 20000;
+  ExtendibleHash<int, int> test(4);
+  for (int i = 0; i < num_old; ++i) {
+    test.Insert(i, i * 2);
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int> wrong(0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 3; ++tid) {
+    threads.push_back(std::thread([&test, &done, &wrong, tid]() {
+      int value;
+      for (int i = tid; !done; i = (i + 7) % num_old) {
+        if (!test.Find(i, value) || value != i * 2) {
+          wrong++;
+        }
+        if (test.Find(num_old + num_new + i, value)) {
+          wrong++;
+        }
+      }
+    }));
+  }
+  std::vector<std::thread> writers;
+  for (int tid = 0; tid < 2; ++tid) {
+    writers.push_back(std::thread([&test, tid]() {
+      for (int i = num_old + tid; i < num_old + num_new; i += 2) {
+        test.Insert(i, i * 2);
+      }
+    }));
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong.load());
+  int value;
+  for (int i = 0; i < num_old + num_new; ++i) {
+    EXPECT_TRUE(test.Find(i, value));
+    EXPECT_EQ(i * 2, value);
+  }
+}
+
+// emptied buckets merge back and the directory shrinks with them
+TEST(ExtendibleHashTest, ShrinkTest) {
+  ExtendibleHash<int, int> test(4);
+  const size_t empty_usage = test.GetMemoryUsage();
+  for (int i = 0; i < 10000; ++i) {
+    test.Insert(i, i);
+  }
+  EXPECT_LT(10, test.GetGlobalDepth());
+  for (int i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(test.Remove(i));
+  }
+  int value;
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i % 2 == 1, test.Find(i, value));
+  }
+  for (int i = 1; i < 10000; i += 2) {
+    EXPECT_TRUE(test.Remove(i));
+  }
+  EXPECT_EQ(1, test.GetNumBuckets());
+  EXPECT_GE(1, test.GetGlobalDepth());
+  EXPECT_GE(empty_usage + sizeof(void *), test.GetMemoryUsage());
+  // and grows again
+  for (int i = 0; i < 10000; ++i) {
+    test.Insert(i, -i);
+  }
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(test.Find(i, value));
+    EXPECT_EQ(-i, value);
+  }
+}
+
+// lock-free readers keep finding the keys while other threads split and merge
+// the buckets around them
+TEST(ExtendibleHashTest, ConcurrentMergeTest) {
+  const int num_old = 1000;
+  const int num_churn = 4000;
+  ExtendibleHash<int, int> test(4);
+  for (int i = 0; i < num_old; ++i) {
+    test.Insert(i * 8, i);
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int> wrong(0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 2; ++tid) {
+    threads.push_back(std::thread([&test, &done, &wrong, tid]() {
+      int value;
+      for (int i = tid; !done; i = (i + 7) % num_old) {
+        if (!test.Find(i * 8, value) || value != i) {
+          wrong++;
+        }
+      }
+    }));
+  }
+  std::vector<std::thread> writers;
+  for (int tid = 0; tid < 2; ++tid) {
+    writers.push_back(std::thread([&test, tid]() {
+      for (int round = 0; round < 5; ++round) {
+        for (int i = tid; i < num_churn; i += 2) {
+          test.Insert(i * 8 + 1, i);
+        }
+        for (int i = tid; i < num_churn; i += 2) {
+          EXPECT_TRUE(test.Remove(i * 8 + 1));
+        }
+      }
+    }));
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong.load());
+  int value;
+  for (int i = 0; i < num_old; ++i) {
+    EXPECT_TRUE(test.Find(i * 8, value));
+    EXPECT_FALSE(test.Find(i * 8 + 1, value));
+  }
+  for (int i = 0; i < num_old; ++i) {
+    EXPECT_TRUE(test.Remove(i * 8));
+  }
+  EXPECT_EQ(1, test.GetNumBuckets());
+}
+
+// batches agree with key by key calls, whether the values can be read without
+// the latch or not
+TEST(ExtendibleHashTest, BatchTest) {
+  ExtendibleHash<int, int> test(8);
+  ExtendibleHash<int, std::string> strings(8);
+  std::vector<int> keys;
+  std::vector<int> values;
+  std::vector<std::string> names;
+  for (int i = 0; i < 2000; ++i) {
+    keys.push_back(i * 3);
+    values.push_back(i);
+    names.push_back(std::to_string(i));
+  }
+  // a key twice: the later value wins
+  keys.push_back(0);
+  values.push_back(-1);
+  names.push_back("-1");
+  test.InsertBatch(keys, values);
+  strings.InsertBatch(keys, names);
+
+  std::vector<int> lookups;
+  for (int i = 0; i < 3000; ++i) {
+    lookups.push_back(i * 2);
+  }
+  std::vector<int> found_values;
+  std::vector<std::string> found_names;
+  std::vector<bool> found;
+  std::vector<bool> found_strings;
+  size_t hits = test.FindBatch(lookups, found_values, found);
+  EXPECT_EQ(hits, strings.FindBatch(lookups, found_names, found_strings));
+  size_t expected = 0;
+  for (size_t i = 0; i < lookups.size(); ++i) {
+    int key = lookups[i];
+    bool there = key % 3 == 0 && key < 6000;
+    expected += there;
+    EXPECT_EQ(there, found[i]);
+    EXPECT_EQ(there, found_strings[i]);
+    if (there) {
+      int value = key == 0 ? -1 : key / 3;
+      EXPECT_EQ(value, found_values[i]);
+      EXPECT_EQ(std::to_string(value), found_names[i]);
+    }
+  }
+  EXPECT_EQ(expected, hits);
+  lookups.clear();
+  EXPECT_EQ(0u, test.FindBatch(lookups, found_values, found));
+  EXPECT_TRUE(found.empty());
+}
+
+/*
+ * Find and Insert key by key against FindBatch and InsertBatch of batch_size
+ * random keys, in a table much bigger than the caches; reports nanoseconds
+ * per key
+ */
+TEST(ExtendibleHashTest, BatchBenchmark) {
+  const int num_keys = 1 << 20;
+  std::mt19937 gen(15445);
+  std::vector<int> keys(num_keys);
+  for (auto &key : keys) {
+    key = static_cast<int>(gen() >> 1);
+  }
+  auto ns_per_key = [](std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_keys;
+  };
+  printf("%6s %10s %10s %10s %10s\n", "batch", "insert", "batch ins",
+         "find", "batch find");
+  for (size_t batch_size : {1, 8, 32, 64, 128, 256}) {
+    ExtendibleHash<int, int> single(64);
+    ExtendibleHash<int, int> batched(64);
+    auto start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      single.Insert(key, key);
+    }
+    double insert = ns_per_key(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += batch_size) {
+      std::vector<int> batch(keys.begin() + i,
+                             keys.begin() + std::min(keys.size(), i + batch_size));
+      batched.InsertBatch(batch, batch);
+    }
+    double insert_batch = ns_per_key(start);
+    int value;
+    start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      single.Find(key, value);
+    }
+    double find = ns_per_key(start);
+    std::vector<int> found_values;
+    std::vector<bool> found;
+    size_t hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += batch_size) {
+      std::vector<int> batch(keys.begin() + i,
+                             keys.begin() + std::min(keys.size(), i + batch_size));
+      hits += batched.FindBatch(batch, found_values, found);
+    }
+    double find_batch = ns_per_key(start);
+    EXPECT_EQ(keys.size(), hits);
+    printf("%6zu %10.1f %10.1f %10.1f %10.1f\n", batch_size, insert,
+           insert_batch, find, find_batch);
+  }
+}
+
+/*
+ * Footprint and lookup latency of a small table, once fresh and once after
+ * it grew to num_peak keys and shrank back
+ */
+TEST(ExtendibleHashTest, GrowShrinkBenchmark) {
+  const int num_live = 1 << 10;
+  const int num_peak = 1 << 18;
+  const int num_lookups = 1 << 20;
+  std::mt19937 gen(15445);
+  std::vector<int> keys(num_peak);
+  for (auto &key : keys) {
+    key = static_cast<int>(gen() >> 1);
+  }
+  ExtendibleHash<int, int> test(16);
+  auto report = [&test, &keys](const char *phase) {
+    int value;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; ++i) {
+      test.Find(keys[i % num_live], value);
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    printf("%-8s %6d %8d %10zu %14.1f\n", phase, test.GetGlobalDepth(),
+           test.GetNumBuckets(), test.GetMemoryUsage() / 1024,
+           elapsed.count() / num_lookups);
+  };
+  printf("%-8s %6s %8s %10s %14s\n", "phase", "depth", "buckets", "KB",
+         "ns per lookup");
+  for (int i = 0; i < num_live; ++i) {
+    test.Insert(keys[i], i);
+  }
+  report("before");
+  size_t before = test.GetMemoryUsage();
+  for (int i = num_live; i < num_peak; ++i) {
+    test.Insert(keys[i], i);
+  }
+  report("peak");
+  size_t peak = test.GetMemoryUsage();
+  for (int i = num_live; i < num_peak; ++i) {
+    test.Remove(keys[i]);
+  }
+  report("after");
+  // merged down to a few times the fresh table, not all the way: buckets
+  // only merge into a half full one
+  EXPECT_GT(peak / 20, test.GetMemoryUsage());
+  EXPECT_LT(before, test.GetMemoryUsage());
+}
+
+/*
+ * Insert, then Find hits and misses, of num_keys random keys; reports
+ * millions of operations per second
+ */
+TEST(ExtendibleHashTest, FindInsertBenchmark) {
+  const int num_keys = 1 << 18;
+  std::mt19937 gen(15445);
+  std::vector<int> keys(num_keys);
+  for (auto &key : keys) {
+    key = static_cast<int>(gen() >> 1);
+  }
+  auto mops = [](std::chrono::steady_clock::time_point start, int ops) {
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return ops / elapsed.count();
+  };
+  printf("%8s %12s %12s %12s %16s\n", "bucket", "insert Mops",
+         "hit Mops", "miss Mops", "4 thr hit Mops");
+  for (size_t bucket_size : {8, 16, 32, 64}) {
+    ExtendibleHash<int, int> test(bucket_size);
+    auto start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      test.Insert(key, key);
+    }
+    double insert = mops(start, num_keys);
+    int value;
+    start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      EXPECT_TRUE(test.Find(key, value));
+    }
+    double hit = mops(start, num_keys);
+    start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      test.Find(key ^ 1, value);
+    }
+    double miss = mops(start, num_keys);
+    std::vector<std::thread> threads;
+    start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < 4; ++tid) {
+      threads.push_back(std::thread([&test, &keys, tid]() {
+        int value;
+        for (size_t i = tid; i < keys.size(); i += 4) {
+          test.Find(keys[i], value);
+        }
+      }));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    double parallel_hit = mops(start, num_keys);
+    printf("%8zu %12.1f %12.1f %12.1f %16.1f\n", bucket_size, insert, hit,
+           miss, parallel_hit);
+  }
+}
+
 } // namespace cmudb
\ No newline at end of file
@@ -0,0 +1,181 @@
+/**
+ * linear_probe_hash_table_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+#include "hash/extendible_hash.h"
+#include "hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  LinearProbeHashTable<int, int> table(8);
+  EXPECT_EQ(16u, table.GetCapacity());
+
+  for (int i = 0; i < 10; ++i) {
+    table.Insert(i, i * 10);
+  }
+  EXPECT_EQ(10u, table.GetSize());
+  int value;
+  EXPECT_TRUE(table.Find(9, value));
+  EXPECT_EQ(90, value);
+  EXPECT_FALSE(table.Find(10, value));
+
+  // overwrite
+  table.Insert(9, 99);
+  EXPECT_TRUE(table.Find(9, value));
+  EXPECT_EQ(99, value);
+  EXPECT_EQ(10u, table.GetSize());
+
+  EXPECT_TRUE(table.Remove(9));
+  EXPECT_FALSE(table.Remove(9));
+  EXPECT_FALSE(table.Find(9, value));
+  EXPECT_EQ(9u, table.GetSize());
+
+  // grow past a load factor of 3/4
+  for (int i = 10; i < 100; ++i) {
+    table.Insert(i, i * 10);
+  }
+  EXPECT_EQ(256u, table.GetCapacity());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i != 9, table.Find(i, value));
+    if (i != 9) {
+      EXPECT_EQ(i * 10, value);
+    }
+  }
+}
+
+// removing entries from the middle of clusters must not lose the rest
+TEST(LinearProbeHashTableTest, ChurnTest) {
+  LinearProbeHashTable<int, int> table(64);
+  std::mt19937 gen(15445);
+  std::vector<bool> present(1000, false);
+  for (int round = 0; round < 100000; ++round) {
+    int key = gen() % 1000;
+    if (present[key]) {
+      EXPECT_TRUE(table.Remove(key));
+    } else if (table.GetSize() < 64) {
+      table.Insert(key, key);
+    } else {
+      continue;
+    }
+    present[key] = !present[key];
+  }
+  // churn never grows the table beyond what the live entries need
+  EXPECT_EQ(128u, table.GetCapacity());
+  int value;
+  for (int key = 0; key < 1000; ++key) {
+    EXPECT_EQ(present[key], table.Find(key, value));
+  }
+  std::vector<int> keys;
+  for (int key = 0; key < 1000; ++key) {
+    keys.push_back(key);
+  }
+  std::vector<int> values;
+  std::vector<bool> found;
+  EXPECT_EQ(table.GetSize(), table.FindBatch(keys, values, found));
+  for (int key = 0; key < 1000; ++key) {
+    EXPECT_EQ(present[key], found[key]);
+    EXPECT_EQ(present[key] ? key : 0, values[key]);
+  }
+}
+
+// readers never see a stable key missing while writers move other keys
+TEST(LinearProbeHashTableTest, ConcurrentTest) {
+  LinearProbeHashTable<int, int> table(128);
+  for (int i = 0; i < 64; ++i) {
+    table.Insert(i, i);
+  }
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 2; ++tid) {
+    threads.push_back(std::thread([&table, tid]() {
+      for (int round = 0; round < 20000; ++round) {
+        int key = 1000 + tid * 100 + round % 100;
+        table.Insert(key, key);
+        table.Remove(key);
+      }
+    }));
+  }
+  for (int tid = 0; tid < 2; ++tid) {
+    threads.push_back(std::thread([&table]() {
+      int value;
+      for (int round = 0; round < 100000; ++round) {
+        int key = round % 64;
+        EXPECT_TRUE(table.Find(key, value));
+        EXPECT_EQ(key, value);
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+/*
+ * Page table workload: mostly lookups, with a page replaced (removed and
+ * inserted) every 16 operations, spread over 1 to 32 threads
+ */
+template <typename Table>
+static double RunPageTableBenchmark(Table *table, int num_threads,
+                                    int num_pages, int total_ops) {
+  for (int i = 0; i < num_pages; ++i) {
+    table->Insert(i, i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.push_back(std::thread([=]() {
+      std::mt19937 gen(tid);
+      int value;
+      // each thread replaces only its own pages so the key set stays stable
+      int own = tid;
+      for (int op = 0; op < total_ops / num_threads; ++op) {
+        if (op % 16 == 0 && own < num_pages) {
+          table->Remove(own);
+          table->Insert(own, own);
+          own += num_threads;
+          if (own >= num_pages) {
+            own = tid;
+          }
+        } else {
+          table->Find(static_cast<int>(gen() % (2 * num_pages)), value);
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TEST(LinearProbeHashTableTest, PageTableBenchmark) {
+  const int num_pages = 1024;
+  const int total_ops = 1 << 20;
+  printf("%8s %18s %18s\n", "threads", "extendible ms", "linear probe ms");
+  for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+    auto extendible = new ExtendibleHash<int, int>(BUCKET_SIZE);
+    auto linear = new LinearProbeHashTable<int, int>(num_pages);
+    double extendible_ms =
+        RunPageTableBenchmark(extendible, num_threads, num_pages, total_ops);
+    double linear_ms =
+        RunPageTableBenchmark(linear, num_threads, num_pages, total_ops);
+    printf("%8d %18.1f %18.1f\n", num_threads, extendible_ms, linear_ms);
+    int value;
+    for (int i = 0; i < num_pages; ++i) {
+      EXPECT_TRUE(linear->Find(i, value));
+    }
+    delete extendible;
+    delete linear;
+  }
+}
+
+} // namespace cmudb
@@ -0,0 +1,49 @@
+/**
+ * replacer_test_util.h
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+/*
+ * Replay a page reference string against replacer managing num_frames frames
+ * the same way the buffer pool does (pin = Erase, unpin = Insert, miss = Victim
+ * + Load) and return the hit ratio
+ */
+double ReplayHitRatio(Replacer<int> *replacer, int num_frames,
+                             const std::vector<page_id_t> &refs) {
+  std::unordered_map<page_id_t, int> page_table;
+  std::vector<page_id_t> frame_page(num_frames, INVALID_PAGE_ID);
+  int next_free = 0;
+  size_t hits = 0;
+  for (auto page_id : refs) {
+    int frame;
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      hits++;
+      frame = it->second;
+      replacer->Erase(frame);
+    } else {
+      if (next_free < num_frames) {
+        frame = next_free++;
+      } else {
+        EXPECT_EQ(true, replacer->Victim(frame));
+        page_table.erase(frame_page[frame]);
+      }
+      frame_page[frame] = page_id;
+      page_table[page_id] = frame;
+      replacer->Load(frame, page_id);
+    }
+    replacer->Insert(frame);
+  }
+  return static_cast<double>(hits) / refs.size();
+}
+
+} // namespace cmudb
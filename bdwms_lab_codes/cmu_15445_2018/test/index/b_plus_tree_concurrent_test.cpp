@@ -201,8 +201,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -256,8 +256,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -313,8 +313,8 @@ TEST(BPlusTreeConcurrentTest, InsertAndGetTest) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -360,8 +360,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -406,8 +406,8 @@ TEST(BPlusTreeConcurrentTest, DeleteAndGetTest) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -453,8 +453,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -503,8 +503,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest3) {
   EXPECT_TRUE(tree.Check(true));
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
 }
 
@@ -554,8 +554,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest4) {
   EXPECT_TRUE(tree.Check(true));
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
 }
 
@@ -657,8 +657,8 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   EXPECT_TRUE(tree.Check(true));
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -722,8 +722,8 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   EXPECT_TRUE(tree.Check(true));
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -819,8 +819,8 @@ TEST(BPlusTreeConcurrentTest, MixTest3) {
   EXPECT_TRUE(tree.Check(true));
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -95,8 +95,8 @@ TEST(BPlusTreeDeleteTests, DeleteTest1) {
   ASSERT_TRUE(bpm->CheckAllUnpined());
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -177,8 +177,8 @@ TEST(BPlusTreeDeleteTests, DeleteTest2) {
   ASSERT_TRUE(bpm->CheckAllUnpined());
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -253,8 +253,8 @@ TEST(BPlusTreeDeleteTests, DeleteBasic) {
   ASSERT_TRUE(bpm->CheckAllUnpined());
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -339,8 +339,8 @@ TEST(BPlusTreeDeleteTests, DeleteScale) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -394,8 +394,8 @@ TEST(BPlusTreeDeleteTests, DeleteRandom) {
   ASSERT_TRUE(tree.Check(true));
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
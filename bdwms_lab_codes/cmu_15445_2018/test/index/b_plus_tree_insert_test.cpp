@@ -73,8 +73,8 @@ TEST(BPlusTreeInsertTests, InsertTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -145,8 +145,8 @@ TEST(BPlusTreeInsertTests, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -216,8 +216,8 @@ TEST(BPlusTreeInsertTests, InsertScale) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -287,8 +287,8 @@ TEST(BPlusTreeInsertTests, InsertReverse) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -363,12 +363,64 @@ TEST(BPlusTreeInsertTests, InsertRandom) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
 }
 
 
+// index pages in a region of their own, upper levels retained
+TEST(BPlusTreeInsertTests, IndexRegionTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(
+      std::vector<size_t>{10, 40}, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree(
+      "foo_pk", bpm->GetRegion(PoolRegion::INDEX), comparator,
+      INVALID_PAGE_ID, true);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  // the header page is created in the data region, and updated through the
+  // index region
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  for (int64_t key = 1; key <= 2000; ++key) {
+    rid.Set(0, static_cast<int32_t>(key));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+    // table pages come and go in the data region meanwhile
+    if (key % 100 == 0) {
+      for (int i = 0; i < 20; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(page_id));
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 2000; ++key) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids);
+    ASSERT_EQ(1u, rids.size());
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+  EXPECT_TRUE(tree.Check(true));
+  EXPECT_EQ(true, bpm->CheckAllUnpined());
+
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
@@ -92,8 +92,8 @@ TEST(BPlusTreePageTests, testInternalPage) {
   bpm->UnpinPage(p2, true);
   bpm->UnpinPage(p3, true);
   bpm->UnpinPage(p4, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
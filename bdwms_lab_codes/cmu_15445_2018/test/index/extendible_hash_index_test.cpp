@@ -0,0 +1,296 @@
+/**
+ * extendible_hash_index_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "index/extendible_hash_table.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+using HashTable8 = ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+
+static void SetKey(GenericKey<8> &index_key, RID &rid, int64_t key) {
+  index_key.SetFromInteger(key);
+  rid.Set(static_cast<int32_t>(key >> 32), static_cast<int>(key));
+}
+
+TEST(ExtendibleHashIndexTest, InsertTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  HashTable8 table("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  // directories are added by the first insert that needs them
+  index_key.SetFromInteger(7919);
+  EXPECT_EQ(-1, table.GetGlobalDepth(index_key));
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 10000; key++) {
+    keys.push_back(key * 7919);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    SetKey(index_key, rid, key);
+    EXPECT_TRUE(table.Insert(index_key, rid));
+  }
+  // unique keys only
+  SetKey(index_key, rid, keys[0]);
+  EXPECT_FALSE(table.Insert(index_key, rid));
+  // 10000 keys need more than one 30 pair bucket per directory
+  EXPECT_LT(0, table.GetGlobalDepth(index_key));
+  EXPECT_TRUE(table.Check());
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.GetValue(index_key, rids));
+    ASSERT_EQ(1u, rids.size());
+    EXPECT_EQ(static_cast<int>(key), rids[0].GetSlotNum());
+  }
+  rids.clear();
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(table.GetValue(index_key, rids));
+  EXPECT_TRUE(rids.empty());
+
+  // reopen from the header page record
+  page_id_t table_header_page_id;
+  HeaderPage *header_page =
+      static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  EXPECT_TRUE(header_page->GetRootId("foo_pk", table_header_page_id));
+  EXPECT_EQ(table.GetHeaderPageId(), table_header_page_id);
+  HashTable8 reopened("foo_pk", bpm, comparator, table_header_page_id);
+  index_key.SetFromInteger(keys[1]);
+  EXPECT_TRUE(reopened.GetValue(index_key, rids));
+  EXPECT_TRUE(reopened.Check());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  EXPECT_TRUE(bpm->CheckAllUnpined());
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashIndexTest, DeleteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  HashTable8 table("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 0; key < 5000; key++) {
+    SetKey(index_key, rid, key);
+    table.Insert(index_key, rid);
+  }
+  for (int64_t key = 0; key < 5000; key += 2) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.Remove(index_key));
+    EXPECT_FALSE(table.Remove(index_key));
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 5000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 1, table.GetValue(index_key, rids));
+  }
+  // the freed pairs are reused
+  for (int64_t key = 0; key < 5000; key += 2) {
+    SetKey(index_key, rid, key);
+    EXPECT_TRUE(table.Insert(index_key, rid));
+  }
+  for (int64_t key = 0; key < 5000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.GetValue(index_key, rids));
+  }
+  EXPECT_TRUE(table.Check());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  EXPECT_TRUE(bpm->CheckAllUnpined());
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a single directory: it reaches its max depth and buckets overflow
+TEST(ExtendibleHashIndexTest, OverflowTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db", 512);
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  HashTable8 table("foo_pk", bpm, comparator, INVALID_PAGE_ID, 0);
+  GenericKey<8> index_key;
+  RID rid;
+  // 64 slots of 30 pairs
+  const int64_t num_keys = 5000;
+  for (int64_t key = 0; key < num_keys; key++) {
+    SetKey(index_key, rid, key);
+    EXPECT_TRUE(table.Insert(index_key, rid));
+  }
+  EXPECT_EQ(6, table.GetGlobalDepth(index_key));
+  EXPECT_TRUE(table.Check());
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.GetValue(index_key, rids));
+  }
+  EXPECT_EQ(static_cast<size_t>(num_keys), rids.size());
+  // emptied overflow pages are unlinked
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(table.Remove(index_key));
+  }
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(table.GetValue(index_key, rids));
+  }
+  EXPECT_TRUE(table.Check());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  EXPECT_TRUE(bpm->CheckAllUnpined());
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashIndexTest, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db", 512);
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  HashTable8 table("foo_pk", bpm, comparator);
+  const int num_threads = 4;
+  const int64_t keys_per_thread = 1000;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread([&table, tid]() {
+      GenericKey<8> index_key;
+      RID rid;
+      std::vector<RID> rids;
+      for (int64_t i = 0; i < keys_per_thread; i++) {
+        int64_t key = i * num_threads + tid;
+        SetKey(index_key, rid, key);
+        EXPECT_TRUE(table.Insert(index_key, rid));
+        // a key of this thread that is there for good, or was just removed
+        if (i % 3 == 2) {
+          index_key.SetFromInteger(key - num_threads);
+          EXPECT_TRUE(table.Remove(index_key));
+          EXPECT_FALSE(table.GetValue(index_key, rids));
+        }
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(table.GetValue(index_key, rids));
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(table.Check());
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < keys_per_thread * num_threads; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    bool removed = (key / num_threads) % 3 == 1;
+    EXPECT_EQ(!removed, table.GetValue(index_key, rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  EXPECT_TRUE(bpm->CheckAllUnpined());
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Page fetches per point lookup, hash table and B+ tree on the same keys
+ */
+TEST(ExtendibleHashIndexTest, LookupFetchesBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  const int64_t num_keys = 50000;
+  HashTable8 table("hash_pk", bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("tree_pk", bpm,
+                                                           comparator);
+  tree.openCheck = false;
+  Transaction transaction(0);
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = 0; key < num_keys; key++) {
+    SetKey(index_key, rid, key);
+    table.Insert(index_key, rid);
+    tree.Insert(index_key, rid, &transaction);
+  }
+
+  std::vector<RID> rids;
+  int64_t found = 0;
+  auto fetches = [bpm]() {
+    BufferPoolStats stats = bpm->GetStats();
+    return stats.fetch_hits + stats.fetch_misses;
+  };
+  uint64_t start = fetches();
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    found += table.GetValue(index_key, rids);
+  }
+  double hash_fetches = static_cast<double>(fetches() - start) / num_keys;
+  start = fetches();
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    found += tree.GetValue(index_key, rids);
+  }
+  double tree_fetches = static_cast<double>(fetches() - start) / num_keys;
+  printf("page fetches per lookup: hash %.2f, b+ tree %.2f\n", hash_fetches,
+         tree_fetches);
+  // directory and bucket
+  EXPECT_EQ(2.0, hash_fetches);
+  EXPECT_EQ(2 * num_keys, found);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
@@ -0,0 +1,101 @@
+/**
+ * page_size_test.cpp
+ *
+ * Compare page sizes on full scans and point lookups (index probe + heap
+ * fetch) with the same amount of buffer pool memory
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree.h"
+#include "logging/common.h"
+#include "table/table_heap.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PageSizeTest, ScanAndLookupBenchmark) {
+  const size_t pool_bytes = 128 * 1024;
+  const int num_tuples = 10000;
+  Schema *schema = ParseCreateStatement("a bigint, b varchar");
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  printf("%10s %8s %10s %12s\n", "page size", "frames", "scan ms",
+         "lookup ms");
+  for (size_t page_size : {512, 4096, 8192, 16384, 32768}) {
+    remove("test.db");
+    remove("test.log");
+    StorageEngine *storage_engine =
+        new StorageEngine("test.db", page_size, pool_bytes / page_size);
+    BufferPoolManager *bpm = storage_engine->buffer_pool_manager_;
+    Transaction *txn = storage_engine->transaction_manager_->Begin();
+    // a zeroed header page holds no records
+    page_id_t header_page_id;
+    bpm->NewPage(header_page_id);
+    bpm->UnpinPage(header_page_id, true);
+
+    TableHeap table(bpm, storage_engine->lock_manager_,
+                    storage_engine->log_manager_, txn);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("pk", bpm,
+                                                             comparator);
+    tree.openCheck = false;
+    GenericKey<8> index_key;
+    RID rid;
+    for (int i = 0; i < num_tuples; ++i) {
+      ASSERT_TRUE(table.InsertTuple(ConstructTuple(schema), rid, txn));
+      index_key.SetFromInteger(i);
+      tree.Insert(index_key, rid, txn);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (auto itr = table.begin(txn); itr != table.end(); ++itr) {
+      ++count;
+    }
+    auto scan_ms = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    EXPECT_EQ(num_tuples, count);
+
+    std::vector<int64_t> keys(num_tuples);
+    for (int i = 0; i < num_tuples; ++i) {
+      keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    start = std::chrono::steady_clock::now();
+    int found = 0;
+    std::vector<RID> rids;
+    Tuple tuple;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, rids);
+      if (rids.size() == 1 && table.GetTuple(rids[0], tuple, txn)) {
+        ++found;
+      }
+    }
+    auto lookup_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    EXPECT_EQ(num_tuples, found);
+
+    printf("%10zu %8zu %10.1f %12.1f\n", page_size, pool_bytes / page_size,
+           scan_ms, lookup_ms);
+    storage_engine->transaction_manager_->Commit(txn);
+    delete txn;
+    delete storage_engine;
+  }
+  remove("test.db");
+  remove("test.log");
+  delete key_schema;
+  delete schema;
+}
+
+} // namespace cmudb
@@ -41,11 +41,15 @@ TEST(TupleTest, TableHeapTest) {
     rid_v.push_back(rid);
   }
 
+  // the scan goes through the buffer pool's sequential ring
+  int count = 0;
   TableIterator itr = table->begin(transaction);
   while (itr != table->end()) {
     // std::cout << itr->ToString(schema) << std::endl;
     ++itr;
+    ++count;
   }
+  EXPECT_EQ(5000, count);
 
   // int i = 0;
   std::random_shuffle(rid_v.begin(), rid_v.end());
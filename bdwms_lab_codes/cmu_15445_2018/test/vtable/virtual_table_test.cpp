@@ -12,6 +12,7 @@ TEST(VtableTest, CreateTest) {
   std::string db_file = "sqlite.db";
   remove(db_file.c_str());
   remove("vtable.db");
+  remove("vtable.warm");
   sqlite3 *db;
   int rc;
   rc = sqlite3_open(db_file.c_str(), &db);
@@ -42,6 +43,41 @@ TEST(VtableTest, CreateTest) {
 
   remove(db_file.c_str());
   remove("vtable.db");
+  remove("vtable.warm");
   return;
 }
+
+TEST(VtableTest, HashIndexTest) {
+  std::string db_file = "sqlite.db";
+  remove(db_file.c_str());
+  remove("vtable.db");
+  remove("vtable.warm");
+  sqlite3 *db;
+  int rc;
+  rc = sqlite3_open(db_file.c_str(), &db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  rc = sqlite3_enable_load_extension(db, 1);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  char *zErrMsg = 0;
+  rc = sqlite3_load_extension(db, "libvtable", 0, &zErrMsg);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE foo2 USING vtable ('a INT, b "
+                          "int, c varchar', 'foo2_pk b using hash')"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo2 VALUES(1, 2, 'hello')"));
+  EXPECT_TRUE(ExecSQL(db, "INSERT INTO foo2 VALUES(3, 4, 'world')"));
+  EXPECT_TRUE(ExecSQL(db, "SELECT * FROM foo2 WHERE b = 4"));
+  EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo2 WHERE b = 2"));
+  EXPECT_TRUE(ExecSQL(db, "SELECT * FROM foo2"));
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo2"));
+
+  rc = sqlite3_close(db);
+  EXPECT_EQ(rc, SQLITE_OK);
+
+  remove(db_file.c_str());
+  remove("vtable.db");
+  remove("vtable.warm");
+}
 } // namespace cmudb